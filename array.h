@@ -3,8 +3,54 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
 
-// 40ULL
+// cell interpretations for arr_reduce and arr_histogram
+#define ARR_I8 0
+#define ARR_I16 1
+#define ARR_I32 2
+#define ARR_I64 3
+#define ARR_U8 4
+#define ARR_U16 5
+#define ARR_U32 6
+#define ARR_U64 7
+#define ARR_F32 8
+#define ARR_F64 9
+
+#define ARR_REDUCE_GRAIN 65536 // fewest cells arr_reduce hands to another thread
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define ARR_KERNEL __attribute__((target_clones("avx2", "default"))) // picked once at load time from the running CPU, vectorized as the build flags allow
+#else
+#define ARR_KERNEL
+#endif
+
+// per-block filters over the cells of an array, see arr_bloom
+typedef struct bloom {
+    unsigned long long *bits; // lines * 8 words per block, every cell sets bits in one 64-byte line
+    size_t block; // cells per filter (power of two)
+    size_t lines; // 64-byte lines per filter
+    size_t blocks; // filters allocated
+    unsigned char stale; // cells moved since the last build: rebuilt by the next search_s
+} bloom;
+
+// i: signed cells | u: unsigned cells | f: floating cells
+typedef union {
+    long long i;
+    unsigned long long u;
+    double f;
+} cell_value;
+
+typedef struct reduction {
+    cell_value sum; // widened to 64 bits (i64 and u64 wrap)
+    cell_value min; // NaN cells are skipped
+    cell_value max;
+    size_t argmin; // first cell holding min (-1: no cell)
+    size_t argmax; // first cell holding max (-1: no cell)
+    size_t count; // cells equal to value
+} reduction;
+
+// 48ULL
 typedef struct __attribute__((packed)) array {
     unsigned char *buffer; // (0x00 -> 0x07)
     size_t length; // (0x08 -> 0x0F)
@@ -22,6 +68,8 @@ typedef struct __attribute__((packed)) array {
         unsigned char __0x27; // reserved field (0x27)
     } config;
 
+    bloom *filter; // skips blocks on search (default: 0x0) (0x28 -> 0x2F)
+
 } array; 
 
 void arr_config(array* _dest, size_t size) {
@@ -38,6 +86,7 @@ void arr_config(array* _dest, size_t size) {
     _dest->config.__0x25 = 0;
     _dest->config.__0x26 = 0;
     _dest->config.__0x27 = 0;
+    _dest->filter = 0x0;
 }
 
 array *arr_init(size_t size) {
@@ -47,6 +96,359 @@ array *arr_init(size_t size) {
     return _dest;
 }
 
+unsigned long long bloomhashcmp_1(const unsigned char *cell, size_t size) {
+    unsigned long long h = 0x9E3779B97F4A7C15ULL ^ size;
+    unsigned long long word;
+
+    for (size_t i = 0; i < size; i += 8) {
+        word = 0;
+        memcpy(&word, cell + i, (size - i < 8) ? size - i : 8);
+        h = (h ^ word) * 0xBF58476D1CE4E5B9ULL;
+        h ^= h >> 31;
+    }
+
+    h ^= h >> 30;
+    h *= 0x94D049BB133111EBULL;
+    return h ^ (h >> 31);
+}
+
+// 4 bits inside one line of the block's filter, so a probe costs a single cache line
+void bloomaddcmp_1(bloom *filter, size_t block, unsigned long long h) {
+    unsigned long long *line = filter->bits + (block * filter->lines + ((h >> 40) & (filter->lines - 1))) * 8;
+    for (int i = 0; i < 4; i++, h >>= 9) line[(h >> 6) & 7] |= 1ULL << (h & 63);
+}
+
+int bloomtestcmp_1(bloom *filter, size_t block, unsigned long long h) {
+    unsigned long long *line = filter->bits + (block * filter->lines + ((h >> 40) & (filter->lines - 1))) * 8;
+    for (int i = 0; i < 4; i++, h >>= 9) if (!(line[(h >> 6) & 7] & (1ULL << (h & 63)))) return 0;
+    return 1;
+}
+
+// one filter per started block of cells, new filters are empty
+int bloomresizecmp_1(array *_dest) {
+    bloom *filter = _dest->filter;
+    size_t blocks = (_dest->length + filter->block - 1) / filter->block;
+    if (blocks <= filter->blocks) return 1;
+
+    size_t words = filter->lines * 8;
+    unsigned long long *bits = (unsigned long long *) realloc(filter->bits, blocks * words * sizeof(unsigned long long));
+    if (!bits) return 0;
+
+    memset(bits + filter->blocks * words, 0, (blocks - filter->blocks) * words * sizeof(unsigned long long));
+    filter->bits = bits;
+    filter->blocks = blocks;
+    return 1;
+}
+
+int bloombuildcmp_1(array *_dest) {
+    bloom *filter = _dest->filter;
+    if (!bloomresizecmp_1(_dest)) return 0;
+
+    memset(filter->bits, 0, filter->blocks * filter->lines * 8 * sizeof(unsigned long long));
+    for (size_t i = 0; i < _dest->length; i++) {
+        bloomaddcmp_1(filter, i / filter->block, bloomhashcmp_1(_dest->buffer + i * _dest->size, _dest->size));
+    }
+
+    filter->stale = 0;
+    return 1;
+}
+
+// after write_s: inserted cells shifted the rest, otherwise the written cells and any new fill are added
+void bloomwritecmp_1(array *_dest, size_t old_length, unsigned char _insert, unsigned char _0xfill, ssize_t *_st, ssize_t *_en, size_t _count) {
+    bloom *filter = _dest->filter;
+    if (filter->stale) return;
+    if (_insert || !bloomresizecmp_1(_dest)) {
+        filter->stale = 1;
+        return;
+    }
+
+    size_t size = _dest->size;
+    if (_dest->length > old_length) {
+        unsigned char fill[size];
+        memset(fill, _0xfill, size);
+        unsigned long long h = bloomhashcmp_1(fill, size);
+
+        for (size_t b = old_length / filter->block; b * filter->block < _dest->length; b++) bloomaddcmp_1(filter, b, h);
+    }
+
+    for (size_t i = 0; i < _count; i++) {
+        for (size_t j = _st[i]; j <= _en[i]; j++) {
+            bloomaddcmp_1(filter, j / filter->block, bloomhashcmp_1(_dest->buffer + j * size, size));
+        }
+    }
+}
+
+/*
+ * Keeps a small Bloom filter per block of cells, so search_s skips every block
+ * none of the needles can be in. Only overwrites, push_back and writes past the end
+ * update the filters in place. push_front, write_s in insert mode, erase_s, align_s
+ * and arr_apply mark them stale, and the next search_s rebuilds them in O(n): with
+ * push_front between searches, every search pays for that rebuild.
+ * Writes made straight into buffer are not seen: call arr_bloom again afterward.
+ * Costs one byte per cell. block: cells per filter, rounded up to a power of two
+ * (0: turn filters off and free them, must be done before freeing the array).
+ */
+void arr_bloom(array *_dest, size_t block) {
+    if (!_dest) return;
+
+    if (_dest->filter) {
+        free(_dest->filter->bits);
+        free(_dest->filter);
+        _dest->filter = 0x0;
+    }
+    if (!block) return;
+
+    bloom *filter = (bloom *) malloc(sizeof(bloom));
+    if (!filter) return;
+
+    filter->block = 64;
+    while (filter->block < block) filter->block <<= 1;
+    filter->lines = filter->block / 64; // 8 bits per cell
+    filter->blocks = 0;
+    filter->bits = 0x0;
+    filter->stale = 1;
+    _dest->filter = filter;
+}
+
+// one pass for sum, min, max and count, vectorized by the compiler; a second, early-exit pass finds the first min and max
+#define ARR_REDUCE_KERNEL(name, type, field, acc) \
+ARR_KERNEL void name(const unsigned char *buffer, size_t st, size_t en, const void *_value, reduction *_result) { \
+    const type *cell = (const type *) buffer; \
+    type value; \
+    memcpy(&value, _value, sizeof(type)); \
+    \
+    size_t first = st; \
+    while (first < en && cell[first] != cell[first]) first++; /* NaN never compares, so it must not seed min and max */ \
+    \
+    acc sum = 0; \
+    type min = cell[first], max = cell[first]; \
+    size_t count = 0; \
+    for (size_t i = st; i <= en; i++) { \
+        sum += cell[i]; \
+        min = (cell[i] < min) ? cell[i] : min; \
+        max = (cell[i] > max) ? cell[i] : max; \
+        count += (cell[i] == value); \
+    } \
+    \
+    _result->sum.field = sum; \
+    _result->min.field = min; \
+    _result->max.field = max; \
+    _result->count = count; \
+    _result->argmin = -1; \
+    _result->argmax = -1; \
+    for (size_t i = st; i <= en && (_result->argmin == (size_t) -1 || _result->argmax == (size_t) -1); i++) { \
+        if (_result->argmin == (size_t) -1 && cell[i] == min) _result->argmin = i; \
+        if (_result->argmax == (size_t) -1 && cell[i] == max) _result->argmax = i; \
+    } \
+}
+
+ARR_REDUCE_KERNEL(cellreducecmp_i8, signed char, i, long long)
+ARR_REDUCE_KERNEL(cellreducecmp_i16, short, i, long long)
+ARR_REDUCE_KERNEL(cellreducecmp_i32, int, i, long long)
+ARR_REDUCE_KERNEL(cellreducecmp_i64, long long, i, long long)
+ARR_REDUCE_KERNEL(cellreducecmp_u8, unsigned char, u, unsigned long long)
+ARR_REDUCE_KERNEL(cellreducecmp_u16, unsigned short, u, unsigned long long)
+ARR_REDUCE_KERNEL(cellreducecmp_u32, unsigned int, u, unsigned long long)
+ARR_REDUCE_KERNEL(cellreducecmp_u64, unsigned long long, u, unsigned long long)
+ARR_REDUCE_KERNEL(cellreducecmp_f32, float, f, double)
+ARR_REDUCE_KERNEL(cellreducecmp_f64, double, f, double)
+
+typedef void (*cell_reducer)(const unsigned char *, size_t, size_t, const void *, reduction *);
+
+cell_reducer cellreducecmp_1(unsigned char _type) {
+    static const cell_reducer reducers[10] = {
+        cellreducecmp_i8, cellreducecmp_i16, cellreducecmp_i32, cellreducecmp_i64,
+        cellreducecmp_u8, cellreducecmp_u16, cellreducecmp_u32, cellreducecmp_u64,
+        cellreducecmp_f32, cellreducecmp_f64
+    };
+    return (_type < 10) ? reducers[_type] : 0x0;
+}
+
+size_t cellwidthcmp_1(unsigned char _type) {
+    static const size_t widths[10] = {1, 2, 4, 8, 1, 2, 4, 8, 4, 8};
+    return (_type < 10) ? widths[_type] : 0;
+}
+
+// folds part, which covers later cells, into _result: ties keep the earlier cell
+void cellmergecmp_1(reduction *_result, const reduction *part, unsigned char _type) {
+    int less_min, greater_max;
+    if (_type >= ARR_F32) {
+        _result->sum.f += part->sum.f;
+        less_min = part->min.f < _result->min.f || _result->min.f != _result->min.f;
+        greater_max = part->max.f > _result->max.f || _result->max.f != _result->max.f;
+    } else if (_type >= ARR_U8) {
+        _result->sum.u += part->sum.u;
+        less_min = part->min.u < _result->min.u;
+        greater_max = part->max.u > _result->max.u;
+    } else {
+        _result->sum.i += part->sum.i;
+        less_min = part->min.i < _result->min.i;
+        greater_max = part->max.i > _result->max.i;
+    }
+
+    _result->count += part->count;
+    if (part->argmin != (size_t) -1 && (_result->argmin == (size_t) -1 || less_min)) {
+        _result->min = part->min;
+        _result->argmin = part->argmin;
+    }
+    if (part->argmax != (size_t) -1 && (_result->argmax == (size_t) -1 || greater_max)) {
+        _result->max = part->max;
+        _result->argmax = part->argmax;
+    }
+}
+
+typedef struct {
+    cell_reducer reducer;
+    const unsigned char *buffer;
+    size_t st, en;
+    const void *value;
+    reduction result;
+    unsigned char started; // running on its own thread
+} cell_task;
+
+void *celltaskcmp_1(void *arg) {
+    cell_task *task = (cell_task *) arg;
+    task->reducer(task->buffer, task->st, task->en, task->value, &task->result);
+    return 0x0;
+}
+
+/*
+ * Reduces the cells in every _st/_en range, read as _type (ARR_I8 ... ARR_F64,
+ * which must match the cell size): their sum, the smallest and largest cell with
+ * the first index holding each, and how many cells equal *_value.
+ * Ranges of at least 2 * ARR_REDUCE_GRAIN cells are split over up to _threads threads.
+ * Returns the number of cells reduced (0: invalid).
+ */
+size_t arr_reduce(
+    array *_dest,
+    ssize_t *_st,
+    ssize_t *_en,
+    size_t _count,
+    unsigned char _type,
+    void *_value,
+    size_t _threads,
+    reduction *_result
+) {
+    cell_reducer reducer = cellreducecmp_1(_type);
+    if (!_dest || !_st || !_en || !_value || !_result || !reducer || cellwidthcmp_1(_type) != _dest->size) return 0;
+
+    for (size_t i = 0; i < _count; i++) {
+        if (_st[i] == -1) _st[i] = _dest->length - 1;
+        if (_en[i] == -1) _en[i] = _dest->length - 1;
+        if (_st[i] < 0 || _en[i] < 0) return 0;
+        if (_st[i] > _dest->length - 1 || _en[i] > _dest->length - 1) return 0;
+
+        if (_st[i] > _en[i]) {
+            size_t temp = _st[i];
+            _st[i] = _en[i];
+            _en[i] = temp;
+        }
+    }
+
+    _result->argmin = -1;
+    _result->argmax = -1;
+    _result->count = 0;
+    _result->sum.u = 0; // also 0.0
+    size_t reduced = 0;
+
+    for (size_t i = 0; i < _count; i++) {
+        size_t cells = _en[i] - _st[i] + 1;
+        size_t parts = cells / ARR_REDUCE_GRAIN;
+        if (parts > _threads) parts = _threads;
+        if (parts < 1) parts = 1;
+
+        cell_task single;
+        cell_task *tasks = &single;
+        pthread_t *workers = 0x0;
+        if (parts > 1) { // on the heap: _threads comes from the caller
+            tasks = (cell_task *) malloc(parts * sizeof(cell_task));
+            workers = (pthread_t *) malloc(parts * sizeof(pthread_t));
+            if (!tasks || !workers) {
+                free(tasks);
+                free(workers);
+                tasks = &single;
+                workers = 0x0;
+                parts = 1;
+            }
+        }
+
+        for (size_t p = 0; p < parts; p++) {
+            tasks[p].reducer = reducer;
+            tasks[p].buffer = _dest->buffer;
+            tasks[p].st = _st[i] + cells * p / parts;
+            tasks[p].en = _st[i] + cells * (p + 1) / parts - 1;
+            tasks[p].value = _value;
+            tasks[p].started = (p < parts - 1) && pthread_create(&workers[p], 0x0, celltaskcmp_1, &tasks[p]) == 0;
+        }
+
+        for (size_t p = 0; p < parts; p++) {
+            if (tasks[p].started) pthread_join(workers[p], 0x0);
+            else celltaskcmp_1(&tasks[p]);
+            cellmergecmp_1(_result, &tasks[p].result, _type);
+        }
+
+        if (tasks != &single) free(tasks);
+        free(workers);
+        reduced += cells;
+    }
+
+    return reduced;
+}
+
+/*
+ * Counts the cells in every _st/_en range, read as _type, into _buckets buckets:
+ * bucket b holds _low + b * _width up to, not including, _low + (b + 1) * _width.
+ * Cells outside every bucket are skipped. _counts is cleared first.
+ * Returns the number of cells counted.
+ */
+size_t arr_histogram(
+    array *_dest,
+    ssize_t *_st,
+    ssize_t *_en,
+    size_t _count,
+    unsigned char _type,
+    double _low,
+    double _width,
+    size_t _buckets,
+    size_t *_counts
+) {
+    if (!_dest || !_st || !_en || !_counts || !_buckets || !(_width > 0) || cellwidthcmp_1(_type) != _dest->size) return 0;
+    memset(_counts, 0, _buckets * sizeof(size_t));
+    size_t counted = 0;
+
+    for (size_t i = 0; i < _count; i++) {
+        if (_st[i] == -1) _st[i] = _dest->length - 1;
+        if (_en[i] == -1) _en[i] = _dest->length - 1;
+        if (_st[i] < 0 || _en[i] < 0) return counted;
+        if (_st[i] > _dest->length - 1 || _en[i] > _dest->length - 1) return counted;
+
+        ssize_t step = (_st[i] <= _en[i]) ? 1 : -1;
+        for (ssize_t j = _st[i]; (step == 1) ? j <= _en[i] : j >= _en[i]; j += step) {
+            const unsigned char *cell = _dest->buffer + j * _dest->size;
+            double x;
+            switch (_type) {
+                case ARR_I8: x = *(const signed char *) cell; break;
+                case ARR_I16: x = *(const short *) cell; break;
+                case ARR_I32: x = *(const int *) cell; break;
+                case ARR_I64: x = (double) *(const long long *) cell; break;
+                case ARR_U8: x = *cell; break;
+                case ARR_U16: x = *(const unsigned short *) cell; break;
+                case ARR_U32: x = *(const unsigned int *) cell; break;
+                case ARR_U64: x = (double) *(const unsigned long long *) cell; break;
+                case ARR_F32: x = *(const float *) cell; break;
+                default: x = *(const double *) cell; break;
+            }
+
+            double b = (x - _low) / _width;
+            if (!(b >= 0 && b < (double) _buckets)) continue;
+            _counts[(size_t) b]++;
+            counted++;
+        }
+    }
+
+    return counted;
+}
+
 void write_s (
     array *_dest, 
     ssize_t *_st, 
@@ -59,6 +461,7 @@ void write_s (
 ) {
     if (!_dest || !_src || !_st || !_en) return;
     
+    size_t old_length = _dest->length;
     unsigned char swaps[_count];
     size_t highest__en = 0;
     
@@ -194,6 +597,8 @@ void write_s (
             );
         }
     }
+
+    if (_dest->filter) bloomwritecmp_1(_dest, old_length, _insert, _0xfill, _st, _en, _count);
 }
 
 void align_s(array *_dest, unsigned char _0xfill) {
@@ -202,6 +607,7 @@ void align_s(array *_dest, unsigned char _0xfill) {
     size_t size = _dest->size;
     unsigned char compare[size];
     memset(compare, _0xfill, size);
+    if (_dest->filter) _dest->filter->stale = 1;
 
     size_t indx = 0;
     for (size_t i = 0; i < _dest->length; i++) {
@@ -320,9 +726,27 @@ ssize_t search_s(
     size_t size = _dest->size;
     size_t result = -1;
 
+    bloom *filter = _dest->filter;
+    if (filter && filter->stale && !bloombuildcmp_1(_dest)) filter = 0x0;
+
+    unsigned long long hashes[(filter) ? _count_length : 1];
+    if (filter) for (size_t k = 0; k < _count_length; k++) hashes[k] = bloomhashcmp_1((unsigned char *) _src + (k * size), size);
+
     for (size_t i = 0; i < _count; i++) {
         ssize_t step = (_st[i] <= _en[i]) ? 1 : -1;
         for (ssize_t j = _st[i]; (step == 1) ? j <= _en[i] : j >= _en[i]; j += step) {
+            if (filter && (j == _st[i] || (j & (filter->block - 1)) == ((step == 1) ? 0 : filter->block - 1))) {
+                size_t b = j / filter->block;
+                size_t k = 0;
+                while (k < _count_length && !bloomtestcmp_1(filter, b, hashes[k])) k++;
+
+                if (k == _count_length) { // no needle in this block: jump to its far edge
+                    ssize_t edge = (step == 1) ? (ssize_t) ((b + 1) * filter->block - 1) : (ssize_t) (b * filter->block);
+                    j = (step == 1) ? ((edge < _en[i]) ? edge : _en[i]) : ((edge > _en[i]) ? edge : _en[i]);
+                    continue;
+                }
+            }
+
             for (size_t k = 0; k < _count_length; k++) {
                 unsigned char *dest = _dest->buffer + (j * size);
                 unsigned char *src = (unsigned char *) _src + (k * size);
@@ -432,6 +856,396 @@ ssize_t search(array *dest, ssize_t *range, ssize_t src) {
     free(range);
 }
 
+// one run of a batch's cells, kept in a tree ordered by position (a treap keyed on cell counts)
+typedef struct piece {
+    size_t left; // child pieces (0: none, pieces count from 1)
+    size_t right;
+    size_t cells; // cells in this subtree
+    size_t start; // first cell in its source
+    size_t length; // cells in this piece
+    unsigned int priority;
+    unsigned char source; // 0: buffer of the array | 1: log of the batch | 2: default cell value
+} piece;
+
+// operations recorded against an array, see arr_batch
+typedef struct batch {
+    array *dest;
+    unsigned char *buffer; // buffer and length of dest when recording started, arr_apply refuses a changed array
+    size_t length;
+    piece *pieces; // pieces[0] is unused
+    size_t count;
+    size_t capacity;
+    size_t root;
+    unsigned char *log; // cells written by the batch
+    size_t log_length; // cells
+    size_t log_capacity;
+    size_t spare; // cells holding the default value at the end, taken by push_back before growing (-1: count again)
+    unsigned int seed;
+} batch;
+
+size_t piececellscmp_1(batch *_batch, size_t p) {
+    return (p) ? _batch->pieces[p].cells : 0;
+}
+
+void pieceupdatecmp_1(batch *_batch, size_t p) {
+    piece *node = _batch->pieces + p;
+    node->cells = piececellscmp_1(_batch, node->left) + node->length + piececellscmp_1(_batch, node->right);
+}
+
+// room for extra pieces up front, so no piece moves in the middle of an operation
+int piecereservecmp_1(batch *_batch, size_t extra) {
+    if (_batch->count + extra <= _batch->capacity) return 1;
+
+    size_t capacity = (_batch->capacity) ? _batch->capacity * 2 : 64;
+    while (capacity < _batch->count + extra) capacity *= 2;
+
+    piece *pieces = (piece *) realloc(_batch->pieces, capacity * sizeof(piece));
+    if (!pieces) return 0;
+
+    _batch->pieces = pieces;
+    _batch->capacity = capacity;
+    return 1;
+}
+
+size_t piecenewcmp_1(batch *_batch, unsigned char source, size_t start, size_t length) {
+    _batch->seed ^= _batch->seed << 13;
+    _batch->seed ^= _batch->seed >> 17;
+    _batch->seed ^= _batch->seed << 5;
+
+    size_t p = _batch->count++;
+    piece *node = _batch->pieces + p;
+    node->left = 0;
+    node->right = 0;
+    node->cells = length;
+    node->start = start;
+    node->length = length;
+    node->priority = _batch->seed;
+    node->source = source;
+    return p;
+}
+
+// every cell of l, then every cell of r
+size_t piecemergecmp_1(batch *_batch, size_t l, size_t r) {
+    if (!l) return r;
+    if (!r) return l;
+
+    if (_batch->pieces[l].priority > _batch->pieces[r].priority) {
+        _batch->pieces[l].right = piecemergecmp_1(_batch, _batch->pieces[l].right, r);
+        pieceupdatecmp_1(_batch, l);
+        return l;
+    }
+
+    _batch->pieces[r].left = piecemergecmp_1(_batch, l, _batch->pieces[r].left);
+    pieceupdatecmp_1(_batch, r);
+    return r;
+}
+
+// first k cells of p to *l, the rest to *r; the one piece straddling k, if any, is cut in two
+void piecesplitcmp_1(batch *_batch, size_t p, size_t k, size_t *l, size_t *r) {
+    if (!p) {
+        *l = 0;
+        *r = 0;
+        return;
+    }
+
+    piece *node = _batch->pieces + p;
+    size_t left = piececellscmp_1(_batch, node->left);
+
+    if (k <= left) {
+        piecesplitcmp_1(_batch, node->left, k, l, &node->left);
+        pieceupdatecmp_1(_batch, p);
+        *r = p;
+    } else if (k >= left + node->length) {
+        piecesplitcmp_1(_batch, node->right, k - left - node->length, &node->right, r);
+        pieceupdatecmp_1(_batch, p);
+        *l = p;
+    } else {
+        size_t cut = k - left;
+        size_t tail = piecenewcmp_1(_batch, node->source, node->start + cut, node->length - cut);
+        size_t right = node->right;
+
+        node->length = cut;
+        node->right = 0;
+        pieceupdatecmp_1(_batch, p);
+        *l = p;
+        *r = piecemergecmp_1(_batch, tail, right);
+    }
+}
+
+void batchinsertcmp_1(batch *_batch, size_t at, unsigned char source, size_t start, size_t length) {
+    size_t l, r;
+    piecesplitcmp_1(_batch, _batch->root, at, &l, &r);
+    _batch->root = piecemergecmp_1(_batch, piecemergecmp_1(_batch, l, piecenewcmp_1(_batch, source, start, length)), r);
+}
+
+void batchremovecmp_1(batch *_batch, size_t at, size_t length) {
+    size_t l, m, r;
+    piecesplitcmp_1(_batch, _batch->root, at, &l, &m);
+    piecesplitcmp_1(_batch, m, length, &m, &r);
+    _batch->root = piecemergecmp_1(_batch, l, r); // m stays unused in pieces until the batch is applied
+}
+
+// copies cells to the end of the log, last cell first when reversed; returns the first log cell or -1
+size_t batchlogcmp_1(batch *_batch, const void *_src, size_t cells, unsigned char reversed) {
+    size_t size = _batch->dest->size;
+    if (_batch->log_length + cells > _batch->log_capacity) {
+        size_t capacity = (_batch->log_capacity) ? _batch->log_capacity * 2 : 64;
+        while (capacity < _batch->log_length + cells) capacity *= 2;
+
+        unsigned char *log = (unsigned char *) realloc(_batch->log, capacity * size);
+        if (!log) return -1;
+        _batch->log = log;
+        _batch->log_capacity = capacity;
+    }
+
+    unsigned char *to = _batch->log + _batch->log_length * size;
+    if (reversed) {
+        for (size_t j = 0; j < cells; j++) memcpy(to + j * size, (const unsigned char *) _src + (cells - 1 - j) * size, size);
+    } else memcpy(to, _src, cells * size);
+
+    _batch->log_length += cells;
+    return _batch->log_length - cells;
+}
+
+// nonzero while every piece from the buffer of the array still sits at its own offset
+int pieceplacedcmp_1(batch *_batch, size_t p, size_t at) {
+    if (!p) return 1;
+    piece *node = _batch->pieces + p;
+    size_t here = at + piececellscmp_1(_batch, node->left);
+
+    if (node->source == 0 && node->start != here) return 0;
+    return pieceplacedcmp_1(_batch, node->left, at) && pieceplacedcmp_1(_batch, node->right, here + node->length);
+}
+
+// materializes the pieces in position order into to; pieces from the buffer of the array are skipped unless moved
+void piececopycmp_1(batch *_batch, size_t p, size_t at, unsigned char *to, unsigned char moved) {
+    if (!p) return;
+    piece *node = _batch->pieces + p;
+    size_t here = at + piececellscmp_1(_batch, node->left);
+    size_t size = _batch->dest->size;
+
+    piececopycmp_1(_batch, node->left, at, to, moved);
+    if (node->source == 1) memcpy(to + here * size, _batch->log + node->start * size, node->length * size);
+    else if (node->source == 2) memset(to + here * size, _batch->dest->config.default_cell_value, node->length * size);
+    else if (moved) memcpy(to + here * size, _batch->buffer + node->start * size, node->length * size);
+    piececopycmp_1(_batch, node->right, here + node->length, to, moved);
+}
+
+// default cells at the end of p, counted from the last one on like push_back does; *stop is set at the first other cell
+size_t piecetrailcmp_1(batch *_batch, size_t p, const unsigned char *compare, unsigned char *stop) {
+    if (!p || *stop) return 0;
+    piece *node = _batch->pieces + p;
+    size_t size = _batch->dest->size;
+    size_t cells = piecetrailcmp_1(_batch, node->right, compare, stop);
+    if (*stop) return cells;
+
+    if (node->source == 2) cells += node->length;
+    else {
+        const unsigned char *from = ((node->source == 1) ? _batch->log : _batch->buffer) + node->start * size;
+        for (size_t i = node->length; i > 0; i--, cells++) {
+            if (memcmp(from + (i - 1) * size, compare, size) != 0) {
+                *stop = 1;
+                return cells;
+            }
+        }
+    }
+    return cells + piecetrailcmp_1(_batch, node->left, compare, stop);
+}
+
+// starts recording against the current cells of the array
+void batchresetcmp_1(batch *_batch) {
+    _batch->buffer = _batch->dest->buffer;
+    _batch->length = (_batch->dest->buffer) ? _batch->dest->length : 0;
+    _batch->count = 1;
+    _batch->log_length = 0;
+    _batch->root = (_batch->length) ? piecenewcmp_1(_batch, 0, 0, _batch->length) : 0;
+}
+
+/*
+ * Records write, insert, erase, push_front and push_back against an array without touching it:
+ * every operation sees the cells as the earlier ones of the batch left them, and costs
+ * O(log pieces) no matter how many cells it shifts. arr_apply then builds the result in one
+ * pass. Indices follow write_s: -1 is the last cell. The array must not change until then.
+ */
+batch *arr_batch(array *_dest) {
+    if (!_dest) return 0x0;
+
+    batch *_batch = (batch *) malloc(sizeof(batch));
+    if (!_batch) return 0x0;
+
+    _batch->dest = _dest;
+    _batch->pieces = 0x0;
+    _batch->capacity = 0;
+    _batch->log = 0x0;
+    _batch->log_capacity = 0;
+    _batch->seed = 0x9E3779B9;
+    _batch->count = 1;
+    if (!piecereservecmp_1(_batch, 2)) {
+        free(_batch);
+        return 0x0;
+    }
+    batchresetcmp_1(_batch);
+    _batch->spare = -1;
+    return _batch;
+}
+
+// cells the array will have once the batch is applied
+size_t arr_batch_length(batch *_batch) {
+    return (_batch) ? piececellscmp_1(_batch, _batch->root) : 0;
+}
+
+// overwrites _st -> _en with _src (reversed when _st > _en), growing with default cells past the end
+int arr_batch_write(batch *_batch, ssize_t _st, ssize_t _en, void *_src) {
+    if (!_batch || !_src) return 0;
+    size_t total = piececellscmp_1(_batch, _batch->root);
+
+    if (_st == -1) _st = total - 1;
+    if (_en == -1) _en = total - 1;
+    if (_st < 0 || _en < 0) return 0;
+
+    unsigned char reversed = _st > _en;
+    size_t st = (reversed) ? _en : _st;
+    size_t en = (reversed) ? _st : _en;
+    if (!piecereservecmp_1(_batch, 4)) return 0;
+
+    size_t start = batchlogcmp_1(_batch, _src, en - st + 1, reversed);
+    if (start == (size_t) -1) return 0;
+
+    if (st > total) batchinsertcmp_1(_batch, total, 2, 0, st - total);
+    if (st < total) batchremovecmp_1(_batch, st, ((en < total) ? en + 1 : total) - st);
+    batchinsertcmp_1(_batch, st, 1, start, en - st + 1);
+
+    if (_batch->spare != (size_t) -1 && en + 1 >= total - _batch->spare) _batch->spare = -1;
+    return 1;
+}
+
+// inserts _count cells from _src before cell _at (-1: after the last cell)
+int arr_batch_insert(batch *_batch, ssize_t _at, size_t _count, void *_src) {
+    if (!_batch || !_src || !_count) return 0;
+    size_t total = piececellscmp_1(_batch, _batch->root);
+
+    if (_at == -1) _at = total;
+    if (_at < 0 || (size_t) _at > total) return 0;
+    if (!piecereservecmp_1(_batch, 2)) return 0;
+
+    size_t start = batchlogcmp_1(_batch, _src, _count, 0);
+    if (start == (size_t) -1) return 0;
+
+    batchinsertcmp_1(_batch, _at, 1, start, _count);
+    if (_batch->spare != (size_t) -1 && (size_t) _at >= total - _batch->spare) _batch->spare = -1;
+    return 1;
+}
+
+/*
+ * Removes _st -> _en. Cells after them move up, unlike erase_s the cells holding the
+ * default value elsewhere stay where they are. Without erase_preference_mode the array
+ * keeps its length: as many default cells are added at the end.
+ */
+int arr_batch_erase(batch *_batch, ssize_t _st, ssize_t _en) {
+    if (!_batch) return 0;
+    size_t total = piececellscmp_1(_batch, _batch->root);
+
+    if (_st == -1) _st = total - 1;
+    if (_en == -1) _en = total - 1;
+    if (_st < 0 || _en < 0) return 0;
+    if (_st > _en) {
+        ssize_t temp = _st;
+        _st = _en;
+        _en = temp;
+    }
+    if ((size_t) _en >= total) return 0;
+    if (!piecereservecmp_1(_batch, 3)) return 0;
+
+    size_t cells = _en - _st + 1;
+    if (_batch->spare != (size_t) -1 && (size_t) _en + 1 >= total - _batch->spare) _batch->spare = -1; // the cell before the default ones may go
+
+    batchremovecmp_1(_batch, _st, cells);
+    if (!_batch->dest->config.erase_preference_mode) {
+        batchinsertcmp_1(_batch, total - cells, 2, 0, cells);
+        if (_batch->spare != (size_t) -1) _batch->spare += cells;
+    }
+    return 1;
+}
+
+int arr_batch_push_front(batch *_batch, void *_src) {
+    return arr_batch_insert(_batch, 0, 1, _src);
+}
+
+// takes the first default cell at the end like push_back, or appends one plus pre_allocation_factor default cells
+int arr_batch_push_back(batch *_batch, void *_src) {
+    if (!_batch || !_src) return 0;
+    size_t total = piececellscmp_1(_batch, _batch->root);
+
+    size_t size = _batch->dest->size;
+    unsigned char compare[size];
+    memset(compare, _batch->dest->config.default_cell_value, size);
+
+    if (_batch->spare == (size_t) -1) {
+        unsigned char stop = 0;
+        _batch->spare = piecetrailcmp_1(_batch, _batch->root, compare, &stop);
+    }
+    size_t spare = _batch->spare;
+
+    if (spare) {
+        if (!arr_batch_write(_batch, total - spare, total - spare, _src)) return 0;
+        spare--;
+    } else {
+        if (!arr_batch_insert(_batch, total, 1, _src)) return 0;
+        spare = _batch->dest->config.pre_allocation_factor;
+        if (spare && piecereservecmp_1(_batch, 2)) batchinsertcmp_1(_batch, total + 1, 2, 0, spare);
+        else spare = 0;
+    }
+
+    _batch->spare = (memcmp(_src, compare, size) == 0) ? (size_t) -1 : spare; // a default cell pushed is still free to push_back
+    return 1;
+}
+
+/*
+ * Applies the batch in one pass: when no cell of the array has to move, the buffer is
+ * resized at most once and only the new cells are written; otherwise the result is built
+ * into one new buffer. The batch is emptied and records against the new cells afterward.
+ * Returns 1, or 0 when out of memory or when the array changed since recording started.
+ */
+int arr_apply(batch *_batch) {
+    if (!_batch) return 0;
+    array *_dest = _batch->dest;
+    if (_dest->buffer != _batch->buffer || (_dest->buffer && _dest->length != _batch->length)) return 0;
+
+    size_t size = _dest->size;
+    size_t length = piececellscmp_1(_batch, _batch->root);
+    unsigned char *buffer = _dest->buffer;
+    unsigned char moved = !pieceplacedcmp_1(_batch, _batch->root, 0);
+
+    if (!length) {
+        free(buffer);
+        buffer = 0x0;
+    } else if (moved) {
+        buffer = (unsigned char *) malloc(length * size);
+        if (!buffer) return 0;
+    } else if (length != _batch->length) {
+        buffer = (unsigned char *) realloc(buffer, length * size);
+        if (!buffer) return 0;
+        _batch->buffer = buffer; // cells kept in place are read from here
+    }
+
+    if (length) piececopycmp_1(_batch, _batch->root, 0, buffer, moved);
+    if (moved) free(_dest->buffer);
+
+    _dest->buffer = buffer;
+    _dest->length = length;
+    if (_dest->filter) _dest->filter->stale = 1;
+
+    batchresetcmp_1(_batch);
+    return 1;
+}
+
+void arr_batch_free(batch *_batch) {
+    if (!_batch) return;
+    free(_batch->pieces);
+    free(_batch->log);
+    free(_batch);
+}
+
 /*
 void array_log(array *buffer) {
     unsigned char *byte = (unsigned char *)buffer->buffer;
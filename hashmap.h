@@ -0,0 +1,295 @@
+#ifndef hashmap_h
+#define hashmap_h
+
+#include <stdlib.h>
+#include <string.h>
+#include "array.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#define HASHMAP_GROUP 16 // control bytes compared at once
+#define HASHMAP_EMPTY 0x00 // control byte of a free slot, taken slots hold 0x80 | the top 7 bits of their key's hash
+#define HASHMAP_MIGRATE_STEP 8 // old slots moved by every put and remove while a resize is underway
+
+// one generation of slots, probed linearly
+typedef struct hash_table {
+    array *cells; // slot i: key then value (0x0: table not allocated)
+    unsigned char *control; // capacity + HASHMAP_GROUP - 1 bytes, the first HASHMAP_GROUP - 1 repeated at the end so a group never wraps
+    size_t capacity; // power of two, at least HASHMAP_GROUP
+    size_t count;
+} hash_table;
+
+typedef struct hashmap {
+    hash_table current; // receives every insert
+    hash_table old; // table being drained into current while resizing (capacity 0: none)
+    size_t cursor; // next old slot to drain
+    size_t key_size;
+    size_t value_size;
+} hashmap;
+
+int tableinitcmp_1(hash_table *table, size_t capacity, size_t cell_size) {
+    table->cells = arr_init(cell_size);
+    if (!table->cells) return 0;
+
+    table->cells->buffer = (unsigned char *) malloc(capacity * cell_size);
+    table->control = (unsigned char *) calloc(capacity + HASHMAP_GROUP - 1, 1); // all empty, without touching the pages yet
+    if (!table->cells->buffer || !table->control) {
+        free(table->cells->buffer);
+        free(table->cells);
+        free(table->control);
+        table->cells = 0x0;
+        return 0;
+    }
+
+    table->cells->length = capacity;
+    table->capacity = capacity;
+    table->count = 0;
+    return 1;
+}
+
+void tablefreecmp_1(hash_table *table) {
+    if (table->cells) {
+        free(table->cells->buffer);
+        free(table->cells);
+    }
+    free(table->control);
+    table->cells = 0x0;
+    table->control = 0x0;
+    table->capacity = 0;
+    table->count = 0;
+}
+
+void tablecontrolcmp_1(hash_table *table, size_t slot, unsigned char value) {
+    table->control[slot] = value;
+    if (slot < HASHMAP_GROUP - 1) table->control[table->capacity + slot] = value;
+}
+
+unsigned char *tablecellcmp_1(hash_table *table, size_t slot) {
+    return table->cells->buffer + slot * table->cells->size;
+}
+
+// bit i: control byte i of the group equals tag | bit i: control byte i is empty
+void tablegroupcmp_1(const unsigned char *group, unsigned char tag, unsigned int *match, unsigned int *empty) {
+#ifdef __SSE2__
+    __m128i bytes = _mm_loadu_si128((const __m128i *) group);
+    *match = (unsigned int) _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8((char) tag)));
+    *empty = ~(unsigned int) _mm_movemask_epi8(bytes) & 0xFFFF;
+#else
+    *match = 0;
+    *empty = 0;
+    for (int i = 0; i < HASHMAP_GROUP; i++) {
+        *match |= (unsigned int) (group[i] == tag) << i;
+        *empty |= (unsigned int) (group[i] == HASHMAP_EMPTY) << i;
+    }
+#endif
+}
+
+// slot holding key, or -1
+size_t tablefindcmp_1(hash_table *table, const void *key, size_t key_size, unsigned long long h) {
+    if (!table->capacity || !table->count) return -1;
+
+    size_t mask = table->capacity - 1;
+    unsigned char tag = (unsigned char) (0x80 | (h >> 57));
+    for (size_t slot = h & mask;; slot = (slot + HASHMAP_GROUP) & mask) {
+        unsigned int match, empty;
+        tablegroupcmp_1(table->control + slot, tag, &match, &empty);
+        if (empty) match &= (empty & -empty) - 1; // the run of taken slots ends at the first empty one
+
+        for (; match; match &= match - 1) {
+            size_t candidate = (slot + __builtin_ctz(match)) & mask;
+            if (memcmp(tablecellcmp_1(table, candidate), key, key_size) == 0) return candidate;
+        }
+        if (empty) return -1;
+    }
+}
+
+// first empty slot from key's home, the table must have one
+size_t tableslotcmp_1(hash_table *table, unsigned long long h) {
+    size_t mask = table->capacity - 1;
+    for (size_t slot = h & mask;; slot = (slot + HASHMAP_GROUP) & mask) {
+        unsigned int match, empty;
+        tablegroupcmp_1(table->control + slot, 0, &match, &empty);
+        if (empty) return (slot + __builtin_ctz(empty)) & mask;
+    }
+}
+
+void tableputcmp_1(hash_table *table, const void *cell, unsigned long long h) {
+    size_t slot = tableslotcmp_1(table, h);
+    memcpy(tablecellcmp_1(table, slot), cell, table->cells->size);
+    tablecontrolcmp_1(table, slot, (unsigned char) (0x80 | (h >> 57)));
+    table->count++;
+}
+
+// backward-shift deletion: later cells of the run move into the hole while that keeps them reachable, so no tombstones are left
+void tableerasecmp_1(hash_table *table, size_t slot, size_t key_size) {
+    size_t mask = table->capacity - 1;
+    size_t size = table->cells->size;
+    size_t hole = slot;
+
+    for (size_t next = (hole + 1) & mask; table->control[next] != HASHMAP_EMPTY; next = (next + 1) & mask) {
+        size_t home = bloomhashcmp_1(tablecellcmp_1(table, next), key_size) & mask;
+        if (((next - home) & mask) < ((next - hole) & mask)) continue; // its home lies after the hole
+
+        memcpy(tablecellcmp_1(table, hole), tablecellcmp_1(table, next), size);
+        tablecontrolcmp_1(table, hole, table->control[next]);
+        hole = next;
+    }
+
+    tablecontrolcmp_1(table, hole, HASHMAP_EMPTY);
+    table->count--;
+}
+
+// moves up to steps old slots into current; the old table is freed once empty
+void hashmigratecmp_1(hashmap *map, size_t steps) {
+    hash_table *old = &map->old;
+    while (old->capacity && steps--) {
+        if (!old->count) {
+            tablefreecmp_1(old);
+            return;
+        }
+
+        size_t slot = map->cursor;
+        if (old->control[slot] == HASHMAP_EMPTY) {
+            map->cursor = (slot + 1) & (old->capacity - 1);
+            continue;
+        }
+
+        unsigned char *cell = tablecellcmp_1(old, slot);
+        tableputcmp_1(&map->current, cell, bloomhashcmp_1(cell, map->key_size));
+        tableerasecmp_1(old, slot, map->key_size); // may pull a later cell into slot, which is visited again
+    }
+    if (old->capacity && !old->count) tablefreecmp_1(old);
+}
+
+// room for one more cell: past 3/4 full, current becomes the old table and drains into one twice as large
+int hashgrowcmp_1(hashmap *map) {
+    size_t total = map->current.count + map->old.count + 1;
+    if (total * 4 <= map->current.capacity * 3) return 1;
+
+    if (map->old.capacity) hashmigratecmp_1(map, (size_t) -1); // an unfinished resize is finished first
+
+    hash_table grown;
+    if (!tableinitcmp_1(&grown, map->current.capacity * 2, map->key_size + map->value_size)) return 0;
+
+    map->old = map->current;
+    map->current = grown;
+    map->cursor = 0;
+    return 1;
+}
+
+/*
+ * Open-addressing hash map of fixed-size cells (key then value) stored in array buffers.
+ * key_size + value_size: up to 65535 bytes, like an array cell. Keys compare bytewise.
+ */
+hashmap *hashmap_init(size_t key_size, size_t value_size) {
+    if (!key_size || key_size + value_size > 65535) return 0x0;
+
+    hashmap *map = (hashmap *) malloc(sizeof(hashmap));
+    if (!map) return 0x0;
+
+    map->key_size = key_size;
+    map->value_size = value_size;
+    map->cursor = 0;
+    map->old.cells = 0x0;
+    map->old.control = 0x0;
+    map->old.capacity = 0;
+    map->old.count = 0;
+
+    if (!tableinitcmp_1(&map->current, HASHMAP_GROUP, key_size + value_size)) {
+        free(map);
+        return 0x0;
+    }
+    return map;
+}
+
+size_t hashmap_size(hashmap *map) {
+    return (map) ? map->current.count + map->old.count : 0;
+}
+
+// value stored for key, valid until the next put or remove (0x0: not found)
+void *hashmap_get(hashmap *map, const void *key) {
+    if (!map || !key) return 0x0;
+    unsigned long long h = bloomhashcmp_1((const unsigned char *) key, map->key_size);
+
+    size_t slot = tablefindcmp_1(&map->current, key, map->key_size, h);
+    if (slot != (size_t) -1) return tablecellcmp_1(&map->current, slot) + map->key_size;
+
+    slot = tablefindcmp_1(&map->old, key, map->key_size, h);
+    if (slot != (size_t) -1) return tablecellcmp_1(&map->old, slot) + map->key_size;
+    return 0x0;
+}
+
+/*
+ * Inserts key with value, or replaces the value of a key already there.
+ * A resize never rehashes everything at once: every put and remove moves a few cells across.
+ * Returns 1, or 0 when out of memory.
+ */
+int hashmap_put(hashmap *map, const void *key, const void *value) {
+    if (!map || !key || (map->value_size && !value)) return 0;
+
+    void *stored = hashmap_get(map, key);
+    if (stored) {
+        memcpy(stored, value, map->value_size);
+        return 1;
+    }
+
+    if (!hashgrowcmp_1(map)) return 0;
+    hashmigratecmp_1(map, HASHMAP_MIGRATE_STEP);
+
+    unsigned long long h = bloomhashcmp_1((const unsigned char *) key, map->key_size);
+    size_t slot = tableslotcmp_1(&map->current, h);
+    unsigned char *cell = tablecellcmp_1(&map->current, slot);
+    memcpy(cell, key, map->key_size);
+    if (map->value_size) memcpy(cell + map->key_size, value, map->value_size);
+    tablecontrolcmp_1(&map->current, slot, (unsigned char) (0x80 | (h >> 57)));
+    map->current.count++;
+    return 1;
+}
+
+// removes key, copying its value to value_out (0x0: dropped); returns 0 when not found
+int hashmap_remove(hashmap *map, const void *key, void *value_out) {
+    if (!map || !key) return 0;
+    unsigned long long h = bloomhashcmp_1((const unsigned char *) key, map->key_size);
+
+    hash_table *table = &map->current;
+    size_t slot = tablefindcmp_1(table, key, map->key_size, h);
+    if (slot == (size_t) -1) {
+        table = &map->old;
+        slot = tablefindcmp_1(table, key, map->key_size, h);
+    }
+    if (slot == (size_t) -1) return 0;
+
+    if (value_out) memcpy(value_out, tablecellcmp_1(table, slot) + map->key_size, map->value_size);
+    tableerasecmp_1(table, slot, map->key_size);
+    hashmigratecmp_1(map, HASHMAP_MIGRATE_STEP);
+    return 1;
+}
+
+/*
+ * Walks the cells in storage order: start with *cursor = 0, every call returns the next
+ * cell (key then value) and 0x0 once all were visited. Put and remove invalidate the walk.
+ */
+void *hashmap_next(hashmap *map, size_t *cursor) {
+    if (!map || !cursor) return 0x0;
+
+    for (; *cursor < map->old.capacity + map->current.capacity; (*cursor)++) {
+        hash_table *table = (*cursor < map->old.capacity) ? &map->old : &map->current;
+        size_t slot = (*cursor < map->old.capacity) ? *cursor : *cursor - map->old.capacity;
+        if (table->control[slot] != HASHMAP_EMPTY) {
+            (*cursor)++;
+            return tablecellcmp_1(table, slot);
+        }
+    }
+    return 0x0;
+}
+
+void hashmap_free(hashmap *map) {
+    if (!map) return;
+    tablefreecmp_1(&map->current);
+    tablefreecmp_1(&map->old);
+    free(map);
+}
+
+#endif
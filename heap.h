@@ -0,0 +1,354 @@
+#ifndef heap_h
+#define heap_h
+
+#include <stdlib.h>
+#include <string.h>
+#include "array.h"
+
+#define HEAP_ALIGN 64 // the cells buffer starts on a cache line
+
+// <0: a goes before b | 0: either | >0: b goes before a
+typedef int (*heap_compare)(const void *a, const void *b, void *context);
+
+typedef struct heap {
+    array *cells; // storage, HEAP_ALIGN-aligned: cells 0 to arity - 2 are padding, so every group of siblings starts on a multiple of arity cells
+    size_t count; // cells in the heap, the rest of cells is free space
+    size_t arity; // children per cell
+    size_t key_offset; // byte offset of the key inside a cell
+    unsigned char key_type; // ARR_I8 ... ARR_F64
+    unsigned char order; // 0: smallest key on top | 1: largest key on top
+    heap_compare compare; // cell order, the key's unless set by heap_comparator
+    void *context; // passed to compare
+    unsigned char *scratch; // the cell being sifted
+
+    size_t *positions; // handle -> slot (0x0: no position index)
+    size_t *handles; // slot -> handle
+    size_t *spare; // handles given back by pop and remove
+    size_t spare_count;
+    size_t next_handle; // handles never given out start here
+    size_t index_capacity; // entries in positions, handles and spare
+} heap;
+
+#define HEAP_KEY_COMPARE(name, type) \
+int name(const void *a, const void *b, void *context) { \
+    size_t offset = ((heap *) context)->key_offset; \
+    type x, y; \
+    memcpy(&x, (const unsigned char *) a + offset, sizeof(type)); \
+    memcpy(&y, (const unsigned char *) b + offset, sizeof(type)); \
+    return (x > y) - (x < y); \
+}
+
+HEAP_KEY_COMPARE(heapkeycmp_i8, signed char)
+HEAP_KEY_COMPARE(heapkeycmp_i16, short)
+HEAP_KEY_COMPARE(heapkeycmp_i32, int)
+HEAP_KEY_COMPARE(heapkeycmp_i64, long long)
+HEAP_KEY_COMPARE(heapkeycmp_u8, unsigned char)
+HEAP_KEY_COMPARE(heapkeycmp_u16, unsigned short)
+HEAP_KEY_COMPARE(heapkeycmp_u32, unsigned int)
+HEAP_KEY_COMPARE(heapkeycmp_u64, unsigned long long)
+HEAP_KEY_COMPARE(heapkeycmp_f32, float)
+HEAP_KEY_COMPARE(heapkeycmp_f64, double)
+
+heap_compare heapkeycmp_1(unsigned char key_type) {
+    static const heap_compare compares[10] = {
+        heapkeycmp_i8, heapkeycmp_i16, heapkeycmp_i32, heapkeycmp_i64,
+        heapkeycmp_u8, heapkeycmp_u16, heapkeycmp_u32, heapkeycmp_u64,
+        heapkeycmp_f32, heapkeycmp_f64
+    };
+    return (key_type < 10) ? compares[key_type] : 0x0;
+}
+
+unsigned char *heapcellcmp_1(heap *h, size_t slot) {
+    return h->cells->buffer + (slot + h->arity - 1) * h->cells->size;
+}
+
+int heapbeforecmp_1(heap *h, const void *a, const void *b) {
+    int result = h->compare(a, b, h->context);
+    return (h->order) ? result > 0 : result < 0;
+}
+
+// cell at slot from moves to slot to, carrying its handle
+void heapmovecmp_1(heap *h, size_t from, size_t to) {
+    memcpy(heapcellcmp_1(h, to), heapcellcmp_1(h, from), h->cells->size);
+    if (!h->positions) return;
+    h->handles[to] = h->handles[from];
+    h->positions[h->handles[to]] = to;
+}
+
+void heapplacecmp_1(heap *h, size_t slot, size_t handle) {
+    memcpy(heapcellcmp_1(h, slot), h->scratch, h->cells->size);
+    if (!h->positions) return;
+    h->handles[slot] = handle;
+    h->positions[handle] = slot;
+}
+
+// scratch goes in at slot, moving up past every parent it goes before
+void heapupcmp_1(heap *h, size_t slot, size_t handle) {
+    while (slot > 0) {
+        size_t parent = (slot - 1) / h->arity;
+        if (!heapbeforecmp_1(h, h->scratch, heapcellcmp_1(h, parent))) break;
+        heapmovecmp_1(h, parent, slot);
+        slot = parent;
+    }
+    heapplacecmp_1(h, slot, handle);
+}
+
+// scratch goes in at slot, moving down while one of its children goes before it; siblings share a cache line when arity * cell size is 64
+void heapdowncmp_1(heap *h, size_t slot, size_t handle) {
+    for (;;) {
+        size_t first = slot * h->arity + 1;
+        if (first >= h->count) break;
+
+        size_t last = (first + h->arity < h->count) ? first + h->arity : h->count;
+        size_t best = first;
+        for (size_t child = first + 1; child < last; child++) {
+            if (heapbeforecmp_1(h, heapcellcmp_1(h, child), heapcellcmp_1(h, best))) best = child;
+        }
+        if (!heapbeforecmp_1(h, heapcellcmp_1(h, best), h->scratch)) break;
+
+        if (best * h->arity + 1 < h->count) __builtin_prefetch(heapcellcmp_1(h, best * h->arity + 1));
+        heapmovecmp_1(h, best, slot);
+        slot = best;
+    }
+    heapplacecmp_1(h, slot, handle);
+}
+
+// Floyd's bottom-up build: O(count)
+void heapbuildcmp_1(heap *h) {
+    if (h->count < 2) return;
+    for (size_t slot = (h->count - 2) / h->arity + 1; slot-- > 0;) {
+        memcpy(h->scratch, heapcellcmp_1(h, slot), h->cells->size);
+        heapdowncmp_1(h, slot, (h->positions) ? h->handles[slot] : 0);
+    }
+}
+
+// direct writes to the buffer are not seen by the array's filters
+void heaptouchcmp_1(heap *h) {
+    if (h->cells->filter) h->cells->filter->stale = 1;
+}
+
+/*
+ * Moves the cells into a new HEAP_ALIGN-aligned buffer of length cells, shift cells further in;
+ * the cells in front and past the old ones hold the default value. realloc, and so write_s,
+ * only keeps malloc's alignment, which would let a group of siblings straddle two cache lines.
+ */
+int heapaligncmp_1(array *cells, size_t length, size_t shift) {
+    size_t size = cells->size;
+    size_t kept = (cells->buffer) ? cells->length : 0;
+    unsigned char *buffer = (unsigned char *) aligned_alloc(HEAP_ALIGN, (length * size + HEAP_ALIGN - 1) / HEAP_ALIGN * HEAP_ALIGN);
+    if (!buffer) return 0;
+
+    memset(buffer, cells->config.default_cell_value, shift * size);
+    if (kept) memcpy(buffer + shift * size, cells->buffer, kept * size);
+    memset(buffer + (shift + kept) * size, cells->config.default_cell_value, (length - shift - kept) * size);
+
+    free(cells->buffer);
+    cells->buffer = buffer;
+    cells->length = length;
+    if (cells->filter) cells->filter->stale = 1;
+    return 1;
+}
+
+// room for one more cell: at least doubled, or by pre_allocation_factor if larger
+int heapreservecmp_1(heap *h) {
+    array *cells = h->cells;
+    if (h->count + h->arity - 1 < cells->length) return 1;
+
+    size_t extra = (cells->length > cells->config.pre_allocation_factor) ? cells->length : cells->config.pre_allocation_factor;
+    return heapaligncmp_1(cells, h->count + h->arity + extra, 0);
+}
+
+int heapindexcmp_1(heap *h, size_t capacity) {
+    if (capacity <= h->index_capacity) return 1;
+    if (capacity < h->index_capacity * 2) capacity = h->index_capacity * 2;
+
+    size_t *positions = (size_t *) realloc(h->positions, capacity * sizeof(size_t));
+    if (!positions) return 0;
+    h->positions = positions;
+
+    size_t *handles = (size_t *) realloc(h->handles, capacity * sizeof(size_t));
+    if (!handles) return 0;
+    h->handles = handles;
+
+    size_t *spare = (size_t *) realloc(h->spare, capacity * sizeof(size_t));
+    if (!spare) return 0;
+    h->spare = spare;
+
+    h->index_capacity = capacity;
+    return 1;
+}
+
+void heapreleasecmp_1(heap *h, size_t handle) {
+    h->positions[handle] = -1;
+    h->spare[h->spare_count++] = handle;
+}
+
+/*
+ * Turns an array into a d-ary heap of its cells, in place and in O(n).
+ * Cells are ordered by the key at _key_offset, read as _key_type (ARR_I8 ... ARR_F64),
+ * smallest on top (_order: 0) or largest on top (_order: 1).
+ * _arity: children per cell (4 or 8 fits a cache line with 16- or 8-byte cells).
+ * The heap owns the array from then on: its buffer is moved to a cache-line aligned one,
+ * which the heap grows itself. Resizing it through write_s would lose the alignment.
+ */
+heap *heap_init(array *_cells, size_t _arity, size_t _key_offset, unsigned char _key_type, unsigned char _order) {
+    if (!_cells || _arity < 2 || !heapkeycmp_1(_key_type) || _key_offset + cellwidthcmp_1(_key_type) > _cells->size) return 0x0;
+
+    heap *h = (heap *) malloc(sizeof(heap));
+    if (!h) return 0x0;
+    h->scratch = (unsigned char *) malloc(_cells->size);
+    if (!h->scratch) {
+        free(h);
+        return 0x0;
+    }
+
+    h->cells = _cells;
+    h->count = _cells->length;
+    h->arity = _arity;
+    h->key_offset = _key_offset;
+    h->key_type = _key_type;
+    h->order = _order;
+    h->compare = heapkeycmp_1(_key_type);
+    h->context = h;
+    h->positions = 0x0;
+    h->handles = 0x0;
+    h->spare = 0x0;
+    h->spare_count = 0;
+    h->next_handle = 0;
+    h->index_capacity = 0;
+
+    if (h->count && !heapaligncmp_1(_cells, h->count + _arity - 1, _arity - 1)) { // padding in front
+        free(h->scratch);
+        free(h);
+        return 0x0;
+    }
+
+    heaptouchcmp_1(h);
+    heapbuildcmp_1(h);
+    return h;
+}
+
+// orders cells with _compare instead of the key (0x0: back to the key), and rebuilds the heap
+void heap_comparator(heap *_heap, heap_compare _compare, void *_context) {
+    if (!_heap) return;
+    _heap->compare = (_compare) ? _compare : heapkeycmp_1(_heap->key_type);
+    _heap->context = (_compare) ? _context : _heap;
+    heaptouchcmp_1(_heap);
+    heapbuildcmp_1(_heap);
+}
+
+/*
+ * Keeps a position index, so heap_update and heap_remove can find a cell by the handle
+ * heap_push returned. Cells already in the heap get handles 0 to heap_size - 1 in storage order.
+ * _enable: 0 frees the index. Returns 1, or 0 when out of memory.
+ */
+int heap_index(heap *_heap, unsigned char _enable) {
+    if (!_heap) return 0;
+
+    free(_heap->positions);
+    free(_heap->handles);
+    free(_heap->spare);
+    _heap->positions = 0x0;
+    _heap->handles = 0x0;
+    _heap->spare = 0x0;
+    _heap->spare_count = 0;
+    _heap->next_handle = 0;
+    _heap->index_capacity = 0;
+    if (!_enable) return 1;
+
+    if (!heapindexcmp_1(_heap, (_heap->count > 16) ? _heap->count : 16)) {
+        heap_index(_heap, 0);
+        return 0;
+    }
+    for (size_t slot = 0; slot < _heap->count; slot++) {
+        _heap->positions[slot] = slot;
+        _heap->handles[slot] = slot;
+    }
+    _heap->next_handle = _heap->count;
+    return 1;
+}
+
+size_t heap_size(heap *_heap) {
+    return (_heap) ? _heap->count : 0;
+}
+
+// cell on top, valid until the next change (0x0: empty)
+const void *heap_top(heap *_heap) {
+    return (_heap && _heap->count) ? heapcellcmp_1(_heap, 0) : 0x0;
+}
+
+// returns the cell's handle with a position index, 0 without one, -1 when out of memory; O(log n)
+size_t heap_push(heap *_heap, const void *_cell) {
+    if (!_heap || !_cell) return -1;
+    memcpy(_heap->scratch, _cell, _heap->cells->size);
+    if (!heapreservecmp_1(_heap)) return -1;
+
+    size_t handle = 0;
+    if (_heap->positions) {
+        if (!heapindexcmp_1(_heap, _heap->count + 1)) return -1;
+        handle = (_heap->spare_count) ? _heap->spare[--_heap->spare_count] : _heap->next_handle++;
+    }
+
+    heaptouchcmp_1(_heap);
+    heapupcmp_1(_heap, _heap->count++, handle);
+    return handle;
+}
+
+// copies the top cell to _out (0x0: dropped) and removes it; returns 0 when empty; O(log n)
+int heap_pop(heap *_heap, void *_out) {
+    if (!_heap || !_heap->count) return 0;
+    if (_out) memcpy(_out, heapcellcmp_1(_heap, 0), _heap->cells->size);
+    if (_heap->positions) heapreleasecmp_1(_heap, _heap->handles[0]);
+
+    heaptouchcmp_1(_heap);
+    if (--_heap->count) {
+        memcpy(_heap->scratch, heapcellcmp_1(_heap, _heap->count), _heap->cells->size);
+        heapdowncmp_1(_heap, 0, (_heap->positions) ? _heap->handles[_heap->count] : 0);
+    }
+    return 1;
+}
+
+// replaces the cell of _handle, which moves up (decrease-key) or down as needed; needs heap_index; O(log n)
+int heap_update(heap *_heap, size_t _handle, const void *_cell) {
+    if (!_heap || !_heap->positions || !_cell || _handle >= _heap->next_handle || _heap->positions[_handle] == (size_t) -1) return 0;
+    size_t slot = _heap->positions[_handle];
+    memcpy(_heap->scratch, _cell, _heap->cells->size);
+
+    heaptouchcmp_1(_heap);
+    if (slot > 0 && heapbeforecmp_1(_heap, _heap->scratch, heapcellcmp_1(_heap, (slot - 1) / _heap->arity))) heapupcmp_1(_heap, slot, _handle);
+    else heapdowncmp_1(_heap, slot, _handle);
+    return 1;
+}
+
+// removes the cell of _handle, copying it to _out (0x0: dropped); needs heap_index; O(log n)
+int heap_remove(heap *_heap, size_t _handle, void *_out) {
+    if (!_heap || !_heap->positions || _handle >= _heap->next_handle || _heap->positions[_handle] == (size_t) -1) return 0;
+    size_t slot = _heap->positions[_handle];
+    if (_out) memcpy(_out, heapcellcmp_1(_heap, slot), _heap->cells->size);
+    heapreleasecmp_1(_heap, _handle);
+
+    heaptouchcmp_1(_heap);
+    if (slot == --_heap->count) return 1;
+
+    size_t handle = _heap->handles[_heap->count];
+    memcpy(_heap->scratch, heapcellcmp_1(_heap, _heap->count), _heap->cells->size);
+    if (slot > 0 && heapbeforecmp_1(_heap, _heap->scratch, heapcellcmp_1(_heap, (slot - 1) / _heap->arity))) heapupcmp_1(_heap, slot, handle);
+    else heapdowncmp_1(_heap, slot, handle);
+    return 1;
+}
+
+// _free_cells: 1 also frees the array and its buffer
+void heap_free(heap *_heap, unsigned char _free_cells) {
+    if (!_heap) return;
+    heap_index(_heap, 0);
+    free(_heap->scratch);
+
+    if (_free_cells) {
+        arr_bloom(_heap->cells, 0);
+        free(_heap->cells->buffer);
+        free(_heap->cells);
+    }
+    free(_heap);
+}
+
+#endif
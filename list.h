@@ -1,79 +1,345 @@
-#ifndef list
-#define list
+#ifndef list_h
+#define list_h
+
+#if defined(__STRICT_ANSI__) && !defined(__cplusplus) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L // fileno and mmap under -std=c99/c11, list.h must then come before other system headers
+#endif
 
 #include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define LIST_SIMD_X86
+#endif
+
+#define LIST_POOL_CLASSES 11 // recycled payload classes: 4, 8, 16, ..., 4096 elements
+#define LIST_SLAB_BYTES 16384 // bytes carved at once for small node classes
+#define LIST_UNROLLED_CAPACITY 256 // default node capacity in unrolled mode
+#define LIST_BULK_BYTES 1048576 // bytes carved at once by list_push_bulk
+#define LIST_PREFETCH_DISTANCE 4 // nodes iterator_for_each reads ahead
+#define LIST_REDUCE_GRAIN 65536 // fewest elements list_reduce hands to another thread
+#define LIST_FILE_MAGIC 0x3154534C // first word of a file written by list_save ("LST1" on little-endian machines)
+#define LIST_FILE_ALIGN 64 // payloads start on a cache line of the file
+#define LIST_RETIRE_BATCH 64 // retired nodes and arrays a thread holds on a concurrent list before waiting out its readers to free them
+#define LIST_STRIPES 16 // per-thread counters of a concurrent list, each on its own cache line
+
+typedef struct slab {
+    int refs; // nodes carved from this block that are not yet freed
+    int *data; // adopted buffer freed along with the block (0x0: none)
+    size_t mapped; // data is a file mapping of this many bytes, unmapped instead of freed (0: from malloc)
+} list_slab;
+
+typedef struct {
+    unsigned int magic; // LIST_FILE_MAGIC
+    int count; // nodes, from head to tail
+    long long payload; // byte offset of the first payload
+    long long total; // elements in all payloads
+} list_file;
+
+typedef struct {
+    long long offset; // elements from the first payload
+    int size;
+    int flags; // LIST_READ_MOSTLY | LIST_HASHED | LIST_SORTED | LIST_SUMMARY
+    int min;
+    int max;
+} list_file_node;
+
+typedef struct {
+    int capacity; // slots, a power of two
+    int shift; // 32 - log2(capacity)
+    int count;
+    int *entries; // (value, position) pairs, position -1: empty slot
+} list_index;
 
 typedef struct node {
-    int *array;
+    int *array; // points to payload, to a heap block once grown past inline_capacity, or into an adopted buffer
     int size;
+    int capacity; // elements available at array
     struct node *nxt;
     struct node *prev;
+    list_slab *slab; // owning slab (0x0: allocated on its own)
+    int pool; // payload class the node recycles into (-1: freed on release)
+    int inline_capacity; // elements available at payload
+    int flags; // LIST_READ_MOSTLY | LIST_HASHED | LIST_ADOPTED | LIST_SORTED | LIST_SUMMARY
+    int *layout; // eytzinger copy of a sorted read-mostly array, values then ranks (0x0: not built)
+    list_index *index; // hash from value to positions of a LIST_HASHED array (0x0: not built)
+    struct node *dropped; // next node waiting to be freed (lock-free mode)
+    int links; // links from other nodes pointing here (lock-free mode)
+    int lock; // spinlock held by writers and by structural changes next to the node (thread-safe mode)
+    unsigned int seq; // odd while the array is being written, readers retry when it moved (thread-safe mode)
+    unsigned int generation; // bumped whenever the array is written or moved, outstanding spans go stale
+    int min; // smallest element (valid with LIST_SUMMARY)
+    int max; // largest element (valid with LIST_SUMMARY)
+    int payload[];
 } list_t;
 
+typedef struct retired {
+    struct retired *next;
+    list_t *node; // unlinked node (0x0: array only)
+    int *array; // replaced heap array (0x0: node only)
+} list_retired;
+
+typedef struct {
+    int readers[2]; // calls in progress, by the phase they entered in
+    int retired_count; // retired below and not yet freed
+    list_retired *retired; // memory calls in progress may still hold (thread-safe mode)
+    list_t *dropped; // deleted nodes no link points to anymore, linked through dropped (lock-free mode)
+} __attribute__((aligned(64))) list_stripe;
+
 typedef struct {
     list_t *tail; // list[-1]: last node
     list_t *head; // list[0]: first node
     int length;
+    list_t *pool[LIST_POOL_CLASSES]; // released nodes waiting for reuse, linked through nxt
+
+    int unrolled; // node capacity in unrolled mode (0: nodes are never split or merged)
+    int indexed; // directory and cumulative describe the current nodes
+    int directory_capacity;
+    list_t **directory; // nodes from head to tail
+    int *cumulative; // elements stored before directory[i] (cumulative[length]: total)
+
+    list_t *finger; // last node resolved by index (0x0: none)
+    int finger_index; // its index, counting from the head
+
+    int threadsafe; // push, pop and iterator calls may run on several threads
+    int lock; // guards head and tail in thread-safe mode
+    int lockfree; // push, pop and take are lock-free, the nodes hang between anchor[0] and anchor[1]
+    list_t *anchor[2]; // sentinels on the head side and on the tail side (lock-free mode)
+    int phase; // stripes count the calls entering now on readers[phase], the other side the ones still to be waited out
+    int reclaim; // held by the thread freeing retired memory
+    list_stripe *stripes; // LIST_STRIPES counters and retired lists (0x0: no concurrent mode used yet)
 } list_ptr;
 
 typedef struct {
     list_t *points;
+    list_ptr *origin; // list the iterator was created from
 } iterator_ptr;
 
+typedef struct {
+    const int *ptr; // first borrowed element (0x0: nothing borrowed)
+    int len;
+    list_t *node; // node the elements live in
+    unsigned int generation; // node->generation when borrowed
+} list_span;
+
+typedef struct {
+    long long sum; // widened, cannot overflow
+    int min;
+    int max;
+    int argmin; // first index of min (0xFFFFFFFF: empty range)
+    int argmax; // first index of max (0xFFFFFFFF: empty range)
+    int count; // elements equal to value
+} list_reduction;
+
+typedef struct {
+    const int *array;
+    int start, end, value;
+    list_reduction result;
+} list_reduce_task;
+
+typedef struct {
+    int node; // node index, counting from the head
+    int offset; // element index inside the node
+} list_hit;
+
 #define FRONT 0x2000
 #define BACK 0x1000
+#define LIST_READ_MOSTLY 0x1
+#define LIST_HASHED 0x2
+#define LIST_ADOPTED 0x100 // array lives in a caller's buffer, never freed or resized in place
+#define LIST_SORTED 0x200 // array is known to be sorted
+#define LIST_SUMMARY 0x400 // min, max and LIST_SORTED are up to date
+#define LIST_ANCHOR 0x800 // sentinel at either end of a lock-free list, never deleted and never counted
 #define TRUE 1
 #define FALSE 0
 
-void mergesortcmp_1(int arr[], int left, int mid, int right) {
-    int n1 = mid - left + 1;
-    int n2 = right - mid;
+void insertionsortcmp_1(int arr[], int left, int right) {
+    for (int i = left + 1; i < right; i++) {
+        int key = arr[i];
+        int j = i - 1;
 
-    int leftArr[n1], rightArr[n2];
-
-    for (int i = 0; i < n1; i++) {
-        leftArr[i] = arr[left + i];
-    }
-    for (int j = 0; j < n2; j++) {
-        rightArr[j] = arr[mid + 1 + j];
+        while (j >= left && arr[j] > key) {
+            arr[j + 1] = arr[j];
+            j--;
+        }
+        arr[j + 1] = key;
     }
+}
 
-    int i = 0, j = 0, k = left;
-    while (i < n1 && j < n2) {
-        if (leftArr[i] <= rightArr[j]) {
-            arr[k] = leftArr[i];
+void mergesortcmp_1(int src[], int dst[], int left, int mid, int right) {
+    int i = left, j = mid, k = left;
+
+    while (i < mid && j < right) {
+        if (src[i] <= src[j]) {
+            dst[k] = src[i];
             i++;
         } else {
-            arr[k] = rightArr[j];
+            dst[k] = src[j];
             j++;
         }
         k++;
     }
 
-    while (i < n1) {
-        arr[k] = leftArr[i];
-        i++;
-        k++;
+    memcpy(dst + k, src + i, (mid - i) * sizeof(int));
+    memcpy(dst + k + (mid - i), src + j, (right - j) * sizeof(int));
+}
+
+void heapsortcmp_1(int arr[], int root, int size) {
+    int value = arr[root];
+
+    while (2 * root + 1 < size) {
+        int child = 2 * root + 1;
+        if (child + 1 < size && arr[child + 1] > arr[child]) child++;
+        if (arr[child] <= value) break;
+
+        arr[root] = arr[child];
+        root = child;
     }
+    arr[root] = value;
+}
 
-    while (j < n2) {
-        arr[k] = rightArr[j];
-        j++;
-        k++;
+void heapsortcmp_2(int arr[], int size) {
+    for (int i = size / 2 - 1; i >= 0; i--) heapsortcmp_1(arr, i, size);
+
+    for (int end = size - 1; end > 0; end--) {
+        int temp = arr[0];
+        arr[0] = arr[end];
+        arr[end] = temp;
+        heapsortcmp_1(arr, 0, end);
+    }
+}
+
+// bottom-up: sorted runs of 32 are merged back and forth between arr and one scratch buffer
+void mergesortcmp_2(int arr[], int size) {
+    for (int i = 0; i < size; i += 32) insertionsortcmp_1(arr, i, (i + 32 < size) ? i + 32 : size);
+    if (size <= 32) return;
+
+    int *scratch = (int *) malloc(size * sizeof(int));
+    if (!scratch) {
+        heapsortcmp_2(arr, size);
+        return;
+    }
+
+    int *src = arr;
+    int *dst = scratch;
+
+    for (int width = 32; width < size; width *= 2) {
+        for (int left = 0; left < size; left += 2 * width) {
+            int mid = (left + width < size) ? left + width : size;
+            int right = (left + 2 * width < size) ? left + 2 * width : size;
+            mergesortcmp_1(src, dst, left, mid, right);
+        }
+
+        int *temp = src;
+        src = dst;
+        dst = temp;
+    }
+
+    if (src != arr) memcpy(arr, src, size * sizeof(int));
+    free(scratch);
+}
+
+// LSD, 8 bits per pass; the sign bit is flipped so negatives order first
+void radixsortcmp_1(int arr[], int size) {
+    if (size <= 64) {
+        insertionsortcmp_1(arr, 0, size);
+        return;
+    }
+
+    unsigned int *scratch = (unsigned int *) malloc(size * sizeof(int));
+    if (!scratch) {
+        heapsortcmp_2(arr, size);
+        return;
+    }
+
+    int count[4][256];
+    memset(count, 0, sizeof(count));
+
+    unsigned int *src = (unsigned int *) arr;
+    unsigned int *dst = scratch;
+
+    for (int i = 0; i < size; i++) {
+        unsigned int key = src[i] ^ 0x80000000u;
+        count[0][key & 0xFF]++;
+        count[1][(key >> 8) & 0xFF]++;
+        count[2][(key >> 16) & 0xFF]++;
+        count[3][key >> 24]++;
+    }
+
+    for (int pass = 0; pass < 4; pass++) {
+        int shift = pass * 8;
+        if (count[pass][((src[0] ^ 0x80000000u) >> shift) & 0xFF] == size) continue; // every key shares this digit
+
+        int offset = 0;
+        for (int d = 0; d < 256; d++) {
+            int c = count[pass][d];
+            count[pass][d] = offset;
+            offset += c;
+        }
+
+        for (int i = 0; i < size; i++) dst[count[pass][((src[i] ^ 0x80000000u) >> shift) & 0xFF]++] = src[i];
+
+        unsigned int *temp = src;
+        src = dst;
+        dst = temp;
     }
+
+    if (src != (unsigned int *) arr) memcpy(arr, src, size * sizeof(int));
+    free(scratch);
 }
 
+// quicksort on [left, right) falling back to heap sort past depth, insertion sort below 16 elements
+void introsortcmp_1(int arr[], int left, int right, int depth) {
+    while (right - left > 16) {
+        if (depth-- == 0) {
+            heapsortcmp_2(arr + left, right - left);
+            return;
+        }
+
+        int mid = left + (right - 1 - left) / 2;
+        int temp;
+        if (arr[mid] < arr[left]) { temp = arr[mid]; arr[mid] = arr[left]; arr[left] = temp; }
+        if (arr[right - 1] < arr[left]) { temp = arr[right - 1]; arr[right - 1] = arr[left]; arr[left] = temp; }
+        if (arr[right - 1] < arr[mid]) { temp = arr[right - 1]; arr[right - 1] = arr[mid]; arr[mid] = temp; }
 
-void mergesortcmp_2(int arr[], int left, int right) {
-    if (left < right) {
-        int mid = left + (right - left) / 2;
+        int pivot = arr[mid];
+        int i = left - 1;
+        int j = right;
 
-        mergesortcmp_2(arr, left, mid); // left side
+        while (1) {
+            do i++; while (arr[i] < pivot);
+            do j--; while (arr[j] > pivot);
+            if (i >= j) break;
 
-        mergesortcmp_2(arr, mid + 1, right); // right side
+            temp = arr[i];
+            arr[i] = arr[j];
+            arr[j] = temp;
+        }
 
-        mergesortcmp_1(arr, left, mid, right);
+        if (j + 1 - left < right - (j + 1)) { // recurse into the smaller side
+            introsortcmp_1(arr, left, j + 1, depth);
+            left = j + 1;
+        } else {
+            introsortcmp_1(arr, j + 1, right, depth);
+            right = j + 1;
+        }
     }
+
+    insertionsortcmp_1(arr, left, right);
+}
+
+void introsortcmp_2(int arr[], int size) {
+    int depth = 0;
+    for (int n = size; n > 1; n >>= 1) depth += 2;
+    introsortcmp_1(arr, 0, size, depth);
 }
 
 void bubblesortcmp_1(list_t *current) {
@@ -96,245 +362,2743 @@ void bubblesortcmp_1(list_t *current) {
     }
 }
 
-int linearsearchcmp_1(list_t *current, int start, int end, int *target, int target_size) {
-    if (start < 0 || end >= current->size) return 0xFFFFFFFF;
-
+int linearsearchcmp_2(const int *array, int start, int end, const int *target, int target_size) {
     int step = (start <= end) ? 1 : -1;
     for (int i = start; (step == 1) ? i <= end : i >= end; i += step) {
-        for (int j = 0; j < target_size; j++) if (current->array[i] == target[j]) return i;
+        for (int j = 0; j < target_size; j++) if (array[i] == target[j]) return i;
     }
 
     return 0xFFFFFFFF;
 }
 
+#ifdef LIST_SIMD_X86
+// 4 elements per compare, every target broadcast against the same block
+__attribute__((target("sse2")))
+int linearsearchcmp_3(const int *array, int start, int end, const int *target, int target_size) {
+    if (start <= end) {
+        int i = start;
+        for (; i + 3 <= end; i += 4) {
+            __m128i block = _mm_loadu_si128((const __m128i *) (array + i));
+            __m128i hit = _mm_setzero_si128();
+            for (int j = 0; j < target_size; j++) hit = _mm_or_si128(hit, _mm_cmpeq_epi32(block, _mm_set1_epi32(target[j])));
+
+            int mask = _mm_movemask_ps(_mm_castsi128_ps(hit));
+            if (mask) return i + __builtin_ctz(mask);
+        }
+        return (i <= end) ? linearsearchcmp_2(array, i, end, target, target_size) : 0xFFFFFFFF;
+    }
 
-int binarysearchcmp_1(list_t *current, int start, int end, int *target, int target_size) {
-    if (end >= current->size || start < 0 || start > end) return 0xFFFFFFFF;
+    int i = start;
+    for (; i - 3 >= end; i -= 4) {
+        __m128i block = _mm_loadu_si128((const __m128i *) (array + i - 3));
+        __m128i hit = _mm_setzero_si128();
+        for (int j = 0; j < target_size; j++) hit = _mm_or_si128(hit, _mm_cmpeq_epi32(block, _mm_set1_epi32(target[j])));
 
-    int left = start;
-    int right = end;
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(hit));
+        if (mask) return i - 3 + (31 - __builtin_clz(mask));
+    }
+    return (i >= end) ? linearsearchcmp_2(array, i, end, target, target_size) : 0xFFFFFFFF;
+}
 
-    while (left <= right) {
-        int mid = (left + right) / 2;
-        for (int i = 0; i < target_size; i++) {
-            if (current->array[mid] == target[i]) {
-                return mid;
+// 16 elements per iteration as two 8-lane compares
+__attribute__((target("avx2")))
+int linearsearchcmp_4(const int *array, int start, int end, const int *target, int target_size) {
+    if (start <= end) {
+        int i = start;
+        for (; i + 15 <= end; i += 16) {
+            __m256i low = _mm256_loadu_si256((const __m256i *) (array + i));
+            __m256i high = _mm256_loadu_si256((const __m256i *) (array + i + 8));
+            __m256i hit_low = _mm256_setzero_si256();
+            __m256i hit_high = _mm256_setzero_si256();
+            for (int j = 0; j < target_size; j++) {
+                __m256i needle = _mm256_set1_epi32(target[j]);
+                hit_low = _mm256_or_si256(hit_low, _mm256_cmpeq_epi32(low, needle));
+                hit_high = _mm256_or_si256(hit_high, _mm256_cmpeq_epi32(high, needle));
             }
-        }
 
-        if (current->array[mid] < target[0]) {
-            left = mid + 1;
-        } else {
-            right = mid - 1;
+            int mask = _mm256_movemask_ps(_mm256_castsi256_ps(hit_low)) | (_mm256_movemask_ps(_mm256_castsi256_ps(hit_high)) << 8);
+            if (mask) return i + __builtin_ctz(mask);
         }
+        return (i <= end) ? linearsearchcmp_3(array, i, end, target, target_size) : 0xFFFFFFFF;
     }
 
-    return 0xFFFFFFFF;
+    int i = start;
+    for (; i - 15 >= end; i -= 16) {
+        __m256i low = _mm256_loadu_si256((const __m256i *) (array + i - 15));
+        __m256i high = _mm256_loadu_si256((const __m256i *) (array + i - 7));
+        __m256i hit_low = _mm256_setzero_si256();
+        __m256i hit_high = _mm256_setzero_si256();
+        for (int j = 0; j < target_size; j++) {
+            __m256i needle = _mm256_set1_epi32(target[j]);
+            hit_low = _mm256_or_si256(hit_low, _mm256_cmpeq_epi32(low, needle));
+            hit_high = _mm256_or_si256(hit_high, _mm256_cmpeq_epi32(high, needle));
+        }
+
+        int mask = _mm256_movemask_ps(_mm256_castsi256_ps(hit_low)) | (_mm256_movemask_ps(_mm256_castsi256_ps(hit_high)) << 8);
+        if (mask) return i - 15 + (31 - __builtin_clz(mask));
+    }
+    return (i >= end) ? linearsearchcmp_3(array, i, end, target, target_size) : 0xFFFFFFFF;
 }
+#endif
 
+// 2: avx2 | 1: sse2 | 0: scalar
+int simdlevelcmp_1() {
+#ifdef LIST_SIMD_X86
+    if (__builtin_cpu_supports("avx2")) return 2;
+    if (__builtin_cpu_supports("sse2")) return 1;
+#endif
+    return 0;
+}
 
+int linearsearchcmp_1(list_t *current, int start, int end, int *target, int target_size) {
+    if (start < 0 || end < 0 || start >= current->size || end >= current->size || !target || target_size <= 0) return 0xFFFFFFFF;
+
+#ifdef LIST_SIMD_X86
+    switch (simdlevelcmp_1()) {
+        case 2:
+            return linearsearchcmp_4(current->array, start, end, target, target_size);
+        case 1:
+            return linearsearchcmp_3(current->array, start, end, target, target_size);
+    }
+#endif
+    return linearsearchcmp_2(current->array, start, end, target, target_size);
+}
 
-/*
- * Description:
- *    - As linked list node stored in a non-contiguous memory locations. It might cause cache miss. Frequently traversing is not recommended.
- *    - Inside node, a contiguous memory block. is provided (array) with useful built in features. You might utilize that instead.
- *    - 9 Avaliable built in features: push, pop, free, write, erase, retrieve, sort, find, size
- *    - Initialize double linked list
- *    - list_ptr *<variable_name> = list_init();
- *
- *
- * Return: pointer to the list_ptr
- * Time Complexity: O(1)
- */
-list_ptr *list_init() {
-    list_ptr *a = (list_ptr *) malloc(sizeof(list_ptr));
-    a->tail = 0x0;
-    a->head = 0x0;
-    a->length = 0;
 
-    return a;
-}
+void reducecmp_2(const int *array, int start, int end, int value, list_reduction *result) {
+    long long sum = 0;
+    int min = INT_MAX, max = INT_MIN, argmin = 0xFFFFFFFF, argmax = 0xFFFFFFFF, count = 0;
 
-/*
- * Adds a new node to the list with the given array.
- * Parameters:
- *    - list_ptr => pointer to the list
- *    - location => FRONT: push to the head | BACK: push to the tail
- *    - size => input size
- *    - input => pointer to the input array
- *
- * Time Complexity: O(array_size)
- */
-void list_push(list_ptr *li, int location, int size ,int *input) {
-    if (!li || size <= 0 || !input || (location != FRONT && location != BACK)) return;
-    list_t *a = (list_t *) malloc(sizeof(list_t));
+    for (int i = start; i <= end; i++) {
+        int x = array[i];
+        sum += x;
+        count += (x == value);
+        if (x < min || argmin == 0xFFFFFFFF) {
+            min = x;
+            argmin = i;
+        }
+        if (x > max || argmax == 0xFFFFFFFF) {
+            max = x;
+            argmax = i;
+        }
+    }
 
-    a->array = (int *) malloc(size * sizeof(int));
-    a->size = size;
-    for (int i = 0; i < size; i++) a->array[i] = input[i];
+    result->sum = sum;
+    result->min = min;
+    result->max = max;
+    result->argmin = argmin;
+    result->argmax = argmax;
+    result->count = count;
+}
 
+// folds part, which covers later indexes, into result: ties keep the earlier index
+void reducemergecmp_1(list_reduction *result, const list_reduction *part) {
+    result->sum += part->sum;
+    result->count += part->count;
+    if (part->argmin != 0xFFFFFFFF && (result->argmin == 0xFFFFFFFF || part->min < result->min)) {
+        result->min = part->min;
+        result->argmin = part->argmin;
+    }
+    if (part->argmax != 0xFFFFFFFF && (result->argmax == 0xFFFFFFFF || part->max > result->max)) {
+        result->max = part->max;
+        result->argmax = part->argmax;
+    }
+}
 
-    if (location == FRONT) {
-        a->nxt = 0x0;
-        a->prev = li->head;
+#ifdef LIST_SIMD_X86
+// 8 lanes, sums widened to 64 bits, each lane keeps the index of its first min and max
+__attribute__((target("avx2")))
+void reducecmp_4(const int *array, int start, int end, int value, list_reduction *result) {
+    int i = start;
+    if (end - start + 1 < 16) {
+        reducecmp_2(array, start, end, value, result);
+        return;
+    }
 
-        if (li->head != 0x0) li->head->nxt = a; else li->tail = a;
-        li->head = a;
+    __m256i sum_low = _mm256_setzero_si256(), sum_high = _mm256_setzero_si256(), count = _mm256_setzero_si256();
+    __m256i min = _mm256_set1_epi32(INT_MAX), max = _mm256_set1_epi32(INT_MIN), needle = _mm256_set1_epi32(value);
+    __m256i index = _mm256_setr_epi32(start, start + 1, start + 2, start + 3, start + 4, start + 5, start + 6, start + 7);
+    __m256i argmin = index, argmax = index, step = _mm256_set1_epi32(8);
+
+    for (; i + 7 <= end; i += 8) {
+        __m256i x = _mm256_loadu_si256((const __m256i *) (array + i));
+        sum_low = _mm256_add_epi64(sum_low, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(x)));
+        sum_high = _mm256_add_epi64(sum_high, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(x, 1)));
+        count = _mm256_sub_epi32(count, _mm256_cmpeq_epi32(x, needle));
+
+        argmin = _mm256_blendv_epi8(argmin, index, _mm256_cmpgt_epi32(min, x));
+        min = _mm256_min_epi32(min, x);
+        argmax = _mm256_blendv_epi8(argmax, index, _mm256_cmpgt_epi32(x, max));
+        max = _mm256_max_epi32(max, x);
+        index = _mm256_add_epi32(index, step);
     }
 
-    if (location == BACK) {
-        a->nxt = li->tail;
-        a->prev = 0x0;
+    long long sums[8];
+    int mins[8], maxs[8], argmins[8], argmaxs[8], counts[8];
+    _mm256_storeu_si256((__m256i *) sums, _mm256_add_epi64(sum_low, sum_high));
+    _mm256_storeu_si256((__m256i *) mins, min);
+    _mm256_storeu_si256((__m256i *) maxs, max);
+    _mm256_storeu_si256((__m256i *) argmins, argmin);
+    _mm256_storeu_si256((__m256i *) argmaxs, argmax);
+    _mm256_storeu_si256((__m256i *) counts, count);
+
+    result->sum = sums[0] + sums[1] + sums[2] + sums[3];
+    result->min = mins[0];
+    result->max = maxs[0];
+    result->argmin = argmins[0];
+    result->argmax = argmaxs[0];
+    result->count = 0;
+    for (int l = 0; l < 8; l++) {
+        result->count += counts[l];
+        if (mins[l] < result->min || (mins[l] == result->min && argmins[l] < result->argmin)) {
+            result->min = mins[l];
+            result->argmin = argmins[l];
+        }
+        if (maxs[l] > result->max || (maxs[l] == result->max && argmaxs[l] < result->argmax)) {
+            result->max = maxs[l];
+            result->argmax = argmaxs[l];
+        }
+    }
 
-        if (li->tail != 0x0) li->tail->prev = a; else li->head = a;
-        li->tail = a;
+    if (i <= end) {
+        list_reduction tail;
+        reducecmp_2(array, i, end, value, &tail);
+        reducemergecmp_1(result, &tail);
     }
+}
+#endif
 
-    li->length++;
+void reducecmp_1(const int *array, int start, int end, int value, list_reduction *result) {
+#ifdef LIST_SIMD_X86
+    if (simdlevelcmp_1() == 2) {
+        reducecmp_4(array, start, end, value, result);
+        return;
+    }
+#endif
+    reducecmp_2(array, start, end, value, result);
 }
 
-/*
- * Removes a node from the list.
- * Parameters:
- *    - list_ptr => pointer to the list
- *    - location => FRONT: pop from the head | BACK: pop from the tail
- *
- * Time Complexity: O(1)
- */
-void list_pop(list_ptr *li, int location) {
-    if (li->tail == 0x0 || !li || (location != FRONT && location != BACK)) return;
+void *reducetaskcmp_1(void *arg) {
+    list_reduce_task *task = (list_reduce_task *) arg;
+    reducecmp_1(task->array, task->start, task->end, task->value, &task->result);
+    return 0x0;
+}
 
-    if (location == BACK) {
-        list_t *tmp = li->tail;
-        li->tail = li->tail->nxt;
-    
-        if (li->tail != 0x0) li->tail->prev = 0x0; else li->head = 0x0;
-        free(tmp->array);
-        free(tmp);
-        li->length--;
+// splits [start, end] into up to threads parts of at least LIST_REDUCE_GRAIN elements, the caller runs the last one
+void reducecmp_3(const int *array, int start, int end, int value, int threads, list_reduction *result) {
+    int parts = (end - start + 1) / LIST_REDUCE_GRAIN;
+    if (parts > threads) parts = threads;
+    if (parts <= 1) {
+        reducecmp_1(array, start, end, value, result);
+        return;
+    }
 
+    list_reduce_task *tasks = (list_reduce_task *) malloc(parts * sizeof(list_reduce_task));
+    pthread_t *workers = (pthread_t *) malloc(parts * sizeof(pthread_t));
+    int *started = (int *) calloc(parts, sizeof(int));
+    if (!tasks || !workers || !started) {
+        free(tasks);
+        free(workers);
+        free(started);
+        reducecmp_1(array, start, end, value, result);
         return;
     }
 
-    if (location == FRONT) {
-        list_t *tmp = li->head;
-        li->head = li->head->prev;
-    
-        if (li->head != 0x0) li->head->nxt = 0x0; else li->tail = 0x0;
-        free(tmp->array);
-        free(tmp);
-        li->length--;
+    long long length = end - start + 1;
+    for (int p = 0; p < parts; p++) {
+        tasks[p].array = array;
+        tasks[p].start = start + (int) (length * p / parts);
+        tasks[p].end = start + (int) (length * (p + 1) / parts) - 1;
+        tasks[p].value = value;
+        if (p < parts - 1) started[p] = (pthread_create(&workers[p], 0x0, reducetaskcmp_1, &tasks[p]) == 0);
+    }
 
-        return;
+    for (int p = 0; p < parts; p++) {
+        if (started[p]) pthread_join(workers[p], 0x0);
+        else reducetaskcmp_1(&tasks[p]);
     }
-}
 
-/*
- * Frees the whole list.
- * Parameters:
- *    - list_ptr => pointer to the list
- * 
- * Time Complexity: O(node)
- */
-void list_free(list_ptr *li) {
-    if (!li) return;
-    list_t *current = li->tail;
-    list_t *tmp;
+    *result = tasks[0].result;
+    for (int p = 1; p < parts; p++) reducemergecmp_1(result, &tasks[p].result);
 
-    while (current != 0x0) {
-        tmp = current;
-        current = current->nxt;
-        free(tmp->array);
-        free(tmp);
+    free(tasks);
+    free(workers);
+    free(started);
+}
+
+// counts[b] gets the elements in [low + b * width, low + (b + 1) * width), the rest are skipped
+int histogramcmp_1(const int *array, int start, int end, int low, int width, int buckets, int *counts) {
+    unsigned long long span = (unsigned long long) width * buckets;
+    int shift = ((width & (width - 1)) == 0) ? __builtin_ctz(width) : -1;
+    int counted = 0;
+
+    memset(counts, 0, buckets * sizeof(int));
+    for (int i = start; i <= end; i++) {
+        unsigned long long d = (unsigned long long) ((long long) array[i] - low);
+        if (d >= span) continue;
+        counts[(shift >= 0) ? d >> shift : d / width]++;
+        counted++;
     }
+
+    return counted;
 }
 
-/*
- * Description:
- *    - Writes the input array to a specific range in a specific list.
- *    - To access the last element, set start and end to -1.
- *    - Automatically resizes the array if end_location exceeds its current size, with extra memory reserved (optional).
- *
- * Parameters:
- *    - list_ptr => pointer to the list
- *    - index => 0: forward | -1: backward
- *    - start, end => write range
- *    - input => pointer to the input array
- *    - reserved => number of extra elements to pre-allocate on resize
- *
- * Time Complexity: O(index + input_size)
- */
-void list_write(list_ptr *li, int index, int start, int end, int *input, int reserved) {
-    if (!li || !input || start > end) return;
 
-    list_t *current = (index >= 0) ? li->head : li->tail;
-    int count = (index >= 0) ? 0 : -1;
+// branchless lower bound: first position in [start, end + 1] whose element is not below target
+int binarysearchcmp_2(const int *array, int start, int end, int target) {
+    const int *base = array + start;
+    int n = end - start + 1;
 
-    while (current != 0x0) {
-        if (count == index) {
-            if (start == -1 && end == -1) {
-                current->array[current->size - 1] = input[0];
-                return;
-            }
+    while (n > 1) {
+        int half = n / 2;
+        __builtin_prefetch(base + half / 2); // both candidates for the next probe
+        __builtin_prefetch(base + half + half / 2);
+        base = (base[half] < target) ? base + half : base;
+        n -= half;
+    }
 
-            if (start < 0) return;
+    return (int) (base - array) + (*base < target);
+}
 
-            if (end >= current->size) {
-                if (reserved < 0) return;
+int eytzingercmp_1(const int *array, int *layout, int i, int k, int n) {
+    if (k > n) return i;
 
-                int *new_array = (int*) realloc(current->array, ((end + 1) + reserved) * sizeof(int));
-                current->array = new_array;
+    i = eytzingercmp_1(array, layout, i, 2 * k, n);
+    layout[k] = array[i];
+    layout[n + 1 + k] = i;
+    return eytzingercmp_1(array, layout, i + 1, 2 * k + 1, n);
+}
 
-                for (int i = 0; i < reserved; i++) current->array[(end + 1) + i] = 0xFFFFFFFF;
+// lower bound over the whole node through its eytzinger layout, built on first use
+int binarysearchcmp_3(list_t *current, int target) {
+    int n = current->size;
 
-                current->size = (end + 1) + reserved;
-            }
+    if (!current->layout) {
+        current->layout = (int *) malloc(2 * (n + 1) * sizeof(int));
+        if (!current->layout) return binarysearchcmp_2(current->array, 0, n - 1, target);
+        eytzingercmp_1(current->array, current->layout, 0, 1, n);
+    }
 
-            for (int i = start; i <= end; i++) current->array[i] = input[i - start];
-            return;
-        }
+    const int *layout = current->layout;
+    int k = 1;
+    while (k <= n) {
+        __builtin_prefetch(layout + 16 * k); // 4 levels below k share one cache line
+        k = 2 * k + (layout[k] < target);
+    }
+    k >>= __builtin_ffs(~k);
 
-        current = (index >= 0) ? current->nxt : current->prev;
-        count += (index >= 0) ? 1 : -1;
+    return (k) ? layout[n + 1 + k] : n;
+}
+
+int binarysearchcmp_1(list_t *current, int start, int end, int *target, int target_size) {
+    if (end >= current->size || start < 0 || start > end || !target || target_size <= 0) return 0xFFFFFFFF;
+
+    int result = 0xFFFFFFFF;
+    for (int i = 0; i < target_size; i++) { // lowest position matching any target
+        int position = (current->flags & LIST_READ_MOSTLY)
+            ? binarysearchcmp_3(current, target[i])
+            : binarysearchcmp_2(current->array, start, end, target[i]);
+        if (position < start) position = start;
+
+        if (position <= end && current->array[position] == target[i] && (result == 0xFFFFFFFF || position < result)) result = position;
     }
+
+    return result;
 }
 
-/*
- * Returns size of an array in a specified list. 
- * Recommended to use in list_write start, end argument to write to the back
- * Eg. list_write(pointer, 0, list_size(pointer, 0) - 1, list_size(pointer, 0) + 9, input, 0);
- * Parameters:
- *    - list_ptr => pointer to the list
- *    - index => 0: forward | -1: backward
- * 
- * Time Complexity: O(index)
- */
-int list_size(list_ptr *li, int index) {
-    if (!li) return;
+// resolves count targets independently, 8 searches advancing in lockstep so their misses overlap
+void binarysearchcmp_4(list_t *current, int start, int end, const int *target, int count, int *result) {
+    const int *array = current->array;
 
-    list_t *current = (index >= 0) ? li->head : li->tail;
-    int count = (index >= 0) ? 0 : -1;
+    for (int q = 0; q < count; q += 8) {
+        int lanes = (count - q < 8) ? count - q : 8;
+        const int *base[8];
+        int position[8];
 
-    while (current != 0x0) {
-        if (count == index) return current->size;
+        if (current->flags & LIST_READ_MOSTLY) {
+            for (int j = 0; j < lanes; j++) position[j] = binarysearchcmp_3(current, target[q + j]);
+        } else {
+            for (int j = 0; j < lanes; j++) base[j] = array + start;
+
+            int n = end - start + 1;
+            while (n > 1) {
+                int half = n / 2;
+                for (int j = 0; j < lanes; j++) {
+                    __builtin_prefetch(base[j] + half / 2);
+                    __builtin_prefetch(base[j] + half + half / 2);
+                }
+                for (int j = 0; j < lanes; j++) base[j] = (base[j][half] < target[q + j]) ? base[j] + half : base[j];
+                n -= half;
+            }
 
-        current = (index >= 0) ? current->nxt : current->prev;
-        count += (index >= 0) ? 1 : -1;
+            for (int j = 0; j < lanes; j++) position[j] = (int) (base[j] - array) + (*base[j] < target[q + j]);
+        }
+
+        for (int j = 0; j < lanes; j++) {
+            int p = (position[j] < start) ? start : position[j];
+            result[q + j] = (p <= end && array[p] == target[q + j]) ? p : 0xFFFFFFFF;
+        }
     }
 }
 
-/*
+
+
+void spincmp_1(int *spins) {
+#ifdef LIST_SIMD_X86
+    __builtin_ia32_pause();
+#endif
+    if (++*spins % 64 == 0) sched_yield(); // the peer we wait on may not be running
+}
+
+void spinlockcmp_1(int *lock) {
+    int spins = 0;
+    while (__atomic_exchange_n(lock, 1, __ATOMIC_ACQUIRE)) {
+        while (__atomic_load_n(lock, __ATOMIC_RELAXED)) spincmp_1(&spins);
+    }
+}
+
+int spintrylockcmp_1(int *lock) {
+    return !__atomic_load_n(lock, __ATOMIC_RELAXED) && !__atomic_exchange_n(lock, 1, __ATOMIC_ACQUIRE);
+}
+
+void spinunlockcmp_1(int *lock) {
+    __atomic_store_n(lock, 0, __ATOMIC_RELEASE);
+}
+
+// seqlock write side: seq stays odd while the node's array is being changed
+void nodeentercmp_1(list_t *current) {
+    spinlockcmp_1(&current->lock);
+    __atomic_store_n(&current->seq, current->seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+void nodeleavecmp_1(list_t *current) {
+    __atomic_store_n(&current->seq, current->seq + 1, __ATOMIC_RELEASE);
+    spinunlockcmp_1(&current->lock);
+}
+
+// seqlock read side: copies size and array into view once no write is in progress, returns the seq to validate with
+unsigned int nodesnapshotcmp_1(list_t *current, list_t *view) {
+    unsigned int seq;
+    int spins = 0;
+    while ((seq = __atomic_load_n(&current->seq, __ATOMIC_ACQUIRE)) & 1) spincmp_1(&spins);
+
+    view->size = __atomic_load_n(&current->size, __ATOMIC_ACQUIRE); // size first: a larger size is never paired with an older array
+    view->array = __atomic_load_n(&current->array, __ATOMIC_ACQUIRE);
+    view->capacity = view->size;
+    view->flags = current->flags & (LIST_SORTED | LIST_SUMMARY); // snapshots never build an eytzinger layout
+    view->min = current->min;
+    view->max = current->max;
+    view->layout = 0x0;
+    view->index = 0x0;
+    return seq;
+}
+
+int nodevalidatecmp_1(list_t *current, unsigned int seq) {
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&current->seq, __ATOMIC_RELAXED) == seq;
+}
+
+// largest pool class an inline payload of capacity elements can serve (-1: none)
+int nodeclasscmp_1(int capacity) {
+    int pool = LIST_POOL_CLASSES - 1;
+    while (pool >= 0 && (4 << pool) > capacity) pool--;
+    return pool;
+}
+
+list_t *nodeacquirecmp_1(list_ptr *li, int size) {
+    int pool = 0;
+    while (pool < LIST_POOL_CLASSES && (4 << pool) < size) pool++;
+
+    if (pool == LIST_POOL_CLASSES) { // oversized: exact fit, never recycled
+        list_t *a = (list_t *) malloc(sizeof(list_t) + size * sizeof(int));
+        if (!a) return 0x0;
+        a->slab = 0x0;
+        a->pool = -1;
+        a->inline_capacity = size;
+        a->capacity = size;
+        a->array = a->payload;
+        a->flags = 0;
+        a->layout = 0x0;
+        a->index = 0x0;
+        a->lock = 0;
+        a->seq = 0;
+        a->generation = 0;
+        return a;
+    }
+
+    if (li && li->pool[pool]) {
+        list_t *a = li->pool[pool];
+        li->pool[pool] = a->nxt;
+        return a;
+    }
+
+    size_t stride = sizeof(list_t) + (4 << pool) * sizeof(int);
+    size_t header = (sizeof(list_slab) + 15) & ~(size_t) 15;
+    int count = (li) ? (int) ((LIST_SLAB_BYTES - header) / stride) : 0;
+
+    if (count <= 1) {
+        list_t *a = (list_t *) malloc(stride);
+        if (!a) return 0x0;
+        a->slab = 0x0;
+        a->pool = pool;
+        a->inline_capacity = 4 << pool;
+        a->capacity = 4 << pool;
+        a->array = a->payload;
+        a->flags = 0;
+        a->layout = 0x0;
+        a->index = 0x0;
+        a->lock = 0;
+        a->seq = 0;
+        a->generation = 0;
+        return a;
+    }
+
+    list_slab *slab = (list_slab *) malloc(header + count * stride);
+    if (!slab) return 0x0;
+    slab->refs = count;
+    slab->data = 0x0;
+    slab->mapped = 0;
+
+    for (int i = count - 1; i >= 0; i--) { // slab[0] is handed out, the rest wait in the pool
+        list_t *a = (list_t *) ((unsigned char *) slab + header + i * stride);
+        a->slab = slab;
+        a->pool = pool;
+        a->inline_capacity = 4 << pool;
+        a->capacity = 4 << pool;
+        a->array = a->payload;
+        a->flags = 0;
+        a->layout = 0x0;
+        a->index = 0x0;
+        a->lock = 0;
+        a->seq = 0;
+        a->generation = 0;
+        if (i == 0) return a;
+
+        a->nxt = li->pool[pool];
+        li->pool[pool] = a;
+    }
+
+    return 0x0;
+}
+
+// multiplicative hash into the top bits, slots hold (value, position) pairs with position -1 when empty
+unsigned int indexslotcmp_1(list_index *index, int value) {
+    return ((unsigned int) value * 2654435769u) >> index->shift;
+}
+
+list_index *indexcreatecmp_1(int size) {
+    int capacity = 8, shift = 29;
+    while (capacity < 2 * size && capacity < 0x40000000) {
+        capacity <<= 1;
+        shift--;
+    }
+
+    list_index *a = (list_index *) malloc(sizeof(list_index));
+    if (!a) return 0x0;
+    a->entries = (int *) malloc(2 * capacity * sizeof(int));
+    if (!a->entries) {
+        free(a);
+        return 0x0;
+    }
+
+    a->capacity = capacity;
+    a->shift = shift;
+    a->count = 0;
+    for (int i = 0; i < capacity; i++) a->entries[2 * i + 1] = -1;
+    return a;
+}
+
+void indexfreecmp_1(list_index *index) {
+    if (!index) return;
+    free(index->entries);
+    free(index);
+}
+
+void indexputcmp_1(list_index *index, int value, int position) {
+    unsigned int mask = index->capacity - 1;
+    unsigned int i = indexslotcmp_1(index, value);
+
+    while (index->entries[2 * i + 1] != -1) i = (i + 1) & mask;
+    index->entries[2 * i] = value;
+    index->entries[2 * i + 1] = position;
+    index->count++;
+}
+
+// returns 0 when the table could not grow, so the caller drops it
+int indexinsertcmp_1(list_index *index, int value, int position) {
+    if (2 * (index->count + 1) > index->capacity) {
+        list_index *grown = indexcreatecmp_1(index->count + 1);
+        if (!grown) return 0;
+
+        for (int i = 0; i < index->capacity; i++) {
+            if (index->entries[2 * i + 1] != -1) indexputcmp_1(grown, index->entries[2 * i], index->entries[2 * i + 1]);
+        }
+        free(index->entries);
+        *index = *grown;
+        free(grown);
+    }
+
+    indexputcmp_1(index, value, position);
+    return 1;
+}
+
+// backward-shift deletion: later entries of the probe run move up, so no tombstones build up
+void indexremovecmp_1(list_index *index, int value, int position) {
+    unsigned int mask = index->capacity - 1;
+    unsigned int i = indexslotcmp_1(index, value);
+
+    while (index->entries[2 * i + 1] != position || index->entries[2 * i] != value) {
+        if (index->entries[2 * i + 1] == -1) return;
+        i = (i + 1) & mask;
+    }
+
+    unsigned int j = i;
+    while (1) {
+        j = (j + 1) & mask;
+        if (index->entries[2 * j + 1] == -1) break;
+
+        unsigned int home = indexslotcmp_1(index, index->entries[2 * j]);
+        if (((j - home) & mask) < ((j - i) & mask)) continue; // entry j still reachable from its home slot
+
+        index->entries[2 * i] = index->entries[2 * j];
+        index->entries[2 * i + 1] = index->entries[2 * j + 1];
+        i = j;
+    }
+
+    index->entries[2 * i + 1] = -1;
+    index->count--;
+}
+
+void indexdropcmp_1(list_t *current) {
+    indexfreecmp_1(current->index);
+    current->index = 0x0;
+}
+
+int indexbuildcmp_1(list_t *current) {
+    indexdropcmp_1(current);
+
+    list_index *index = indexcreatecmp_1(current->size);
+    if (!index) return 0;
+    for (int i = 0; i < current->size; i++) indexputcmp_1(index, current->array[i], i);
+
+    current->index = index;
+    return 1;
+}
+
+// first match in [start, end] (walking backward when start > end), as linearsearchcmp_1 would return it
+int indexfindcmp_1(list_t *current, int start, int end, int *target, int target_size) {
+    if (start < 0 || end < 0 || start >= current->size || end >= current->size || !target || target_size <= 0) return 0xFFFFFFFF;
+
+    list_index *index = current->index;
+    unsigned int mask = index->capacity - 1;
+    int low = (start <= end) ? start : end;
+    int high = (start <= end) ? end : start;
+    int result = 0xFFFFFFFF;
+
+    for (int t = 0; t < target_size; t++) {
+        unsigned int i = indexslotcmp_1(index, target[t]);
+        for (; index->entries[2 * i + 1] != -1; i = (i + 1) & mask) {
+            int position = index->entries[2 * i + 1];
+            if (index->entries[2 * i] != target[t] || position < low || position > high) continue;
+
+            if (result == 0xFFFFFFFF || ((start <= end) ? position < result : position > result)) result = position;
+        }
+    }
+
+    return result;
+}
+
+// false while the array is the inline payload or a caller's buffer adopted by list_adopt_bulk
+int nodeownscmp_1(list_t *current) {
+    return current->array != current->payload && !(current->flags & LIST_ADOPTED);
+}
+
+// array changed: drops what was derived from it, except the hash index which the caller keeps up to date
+// frees the eytzinger copy, rebuilt by the next binary search of a read-mostly node
+void nodelayoutdropcmp_1(list_t *current) {
+    if (current->layout) {
+        free(current->layout);
+        current->layout = 0x0;
+    }
+}
+
+void nodetouchcmp_2(list_t *current) {
+    current->generation++;
+    current->flags &= ~(LIST_SORTED | LIST_SUMMARY);
+    nodelayoutdropcmp_1(current);
+}
+
+void nodetouchcmp_1(list_t *current) {
+    nodetouchcmp_2(current);
+    indexdropcmp_1(current);
+}
+
+// smallest, largest and sortedness in one pass, kept until the next nodetouchcmp_1
+void nodesummarycmp_1(list_t *current) {
+    if (current->flags & LIST_SUMMARY) return;
+
+    int min = INT_MAX, max = INT_MIN, sorted = 1;
+    for (int i = 0; i < current->size; i++) {
+        int value = current->array[i];
+        if (value < min) min = value;
+        if (value > max) max = value;
+        if (i > 0 && current->array[i - 1] > value) sorted = 0;
+    }
+
+    current->min = min;
+    current->max = max;
+    current->flags |= LIST_SUMMARY | ((sorted) ? LIST_SORTED : 0);
+}
+
+// summary of an array just sorted: its ends
+void nodesortedcmp_1(list_t *current) {
+    current->min = (current->size) ? current->array[0] : INT_MAX;
+    current->max = (current->size) ? current->array[current->size - 1] : INT_MIN;
+    current->flags |= LIST_SUMMARY | LIST_SORTED;
+}
+
+// TRUE when the node's summary proves no target can be in it
+int nodeexcludescmp_1(list_t *current, const int *target, int target_size) {
+    if (!(current->flags & LIST_SUMMARY)) return FALSE;
+
+    for (int i = 0; i < target_size; i++) if (target[i] >= current->min && target[i] <= current->max) return FALSE;
+    return TRUE;
+}
+
+void nodefreecmp_1(list_t *current) {
+    if (nodeownscmp_1(current)) free(current->array);
+    free(current->layout);
+    indexfreecmp_1(current->index);
+
+    if (!current->slab) {
+        free(current);
+        return;
+    }
+
+    if (--current->slab->refs == 0) {
+        if (current->slab->mapped) munmap(current->slab->data, current->slab->mapped);
+        else free(current->slab->data);
+        free(current->slab);
+    }
+}
+
+void pooldraincmp_1(list_ptr *li) {
+    for (int i = 0; i < LIST_POOL_CLASSES; i++) {
+        while (li->pool[i] != 0x0) {
+            list_t *tmp = li->pool[i];
+            li->pool[i] = tmp->nxt;
+            nodefreecmp_1(tmp);
+        }
+    }
+}
+
+void nodereleasecmp_1(list_ptr *li, list_t *current) {
+    if (!li || current->pool < 0) {
+        nodefreecmp_1(current);
+        return;
+    }
+
+    if (current->array != current->payload) { // an adopted or mapped array stays with its buffer
+        if (nodeownscmp_1(current)) free(current->array);
+        current->array = current->payload;
+        current->capacity = current->inline_capacity;
+    }
+
+    nodetouchcmp_1(current);
+    current->flags = 0;
+    current->nxt = li->pool[current->pool];
+    li->pool[current->pool] = current;
+}
+
+int nodegrowcmp_1(list_t *current, int size) {
+    if (size <= current->capacity) return 1;
+
+    int *new_array;
+    if (!nodeownscmp_1(current)) {
+        new_array = (int *) malloc(size * sizeof(int));
+        if (!new_array) return 0;
+        memcpy(new_array, current->array, current->size * sizeof(int));
+    } else {
+        new_array = (int *) realloc(current->array, size * sizeof(int));
+        if (!new_array) return 0;
+    }
+
+    current->array = new_array;
+    current->capacity = size;
+    current->flags &= ~LIST_ADOPTED;
+    current->generation++;
+    return 1;
+}
+
+// capacity to grow to for size elements: at least double, so appending is amortized O(1)
+int nodegrowthcmp_1(list_t *current, int size) {
+    if (size <= current->capacity || current->capacity > INT_MAX / 2) return size;
+    return (size > 2 * current->capacity) ? size : 2 * current->capacity;
+}
+
+// cuts the array down to capacity elements, back into the node when they fit
+void nodefitcmp_1(list_t *current, int capacity) {
+    if (!nodeownscmp_1(current) || capacity >= current->capacity) return;
+    current->generation++;
+
+    if (capacity <= current->inline_capacity) {
+        memcpy(current->payload, current->array, current->size * sizeof(int));
+        free(current->array);
+        current->array = current->payload;
+        current->capacity = current->inline_capacity;
+        return;
+    }
+
+    int *new_array = (int *) realloc(current->array, capacity * sizeof(int));
+    if (!new_array) return;
+    current->array = new_array;
+    current->capacity = capacity;
+}
+
+// memory is only given back once the array is at most a quarter full, then halved to twice the size
+void nodeshrinkcmp_1(list_t *current, int size) {
+    current->size = size;
+    if (size <= current->capacity / 4) nodefitcmp_1(current, size * 2);
+}
+
+// stripe of the calling thread, handed out round robin on its first call
+int stripecmp_1(void) {
+    static int next = 0;
+    static __thread int stripe = -1;
+    if (stripe < 0) stripe = __atomic_fetch_add(&next, 1, __ATOMIC_RELAXED) % LIST_STRIPES;
+    return stripe;
+}
+
+// calls on a thread-safe list may still hold an unlinked node or a replaced array, so both wait here for them to return;
+// a is allocated by the caller before it unlinks anything, so retiring itself cannot fail
+void noderetirecmp_1(list_ptr *li, list_retired *a, list_t *current, int *array) {
+    list_stripe *stripe = &li->stripes[stripecmp_1()];
+    a->node = current;
+    a->array = array;
+    a->next = __atomic_load_n(&stripe->retired, __ATOMIC_RELAXED);
+    while (!__atomic_compare_exchange_n(&stripe->retired, &a->next, a, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+    __atomic_fetch_add(&stripe->retired_count, 1, __ATOMIC_RELAXED);
+}
+
+// lock-free lists retire a deleted node once no link points to it anymore, through the node itself
+void nodedropcmp_1(list_ptr *li, list_t *current) {
+    list_stripe *stripe = &li->stripes[stripecmp_1()];
+    current->dropped = __atomic_load_n(&stripe->dropped, __ATOMIC_RELAXED);
+    while (!__atomic_compare_exchange_n(&stripe->dropped, &current->dropped, current, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+    __atomic_fetch_add(&stripe->retired_count, 1, __ATOMIC_RELAXED);
+}
+
+// frees what was retired once every call that could still reach it has returned: the phase flips twice and
+// each side's count must drain, calls entering meanwhile count on the other side, so the wait is bounded
+void nodereclaimcmp_2(list_ptr *li) {
+    if (!spintrylockcmp_1(&li->reclaim)) return; // another thread is at it
+
+    list_retired *retired[LIST_STRIPES];
+    list_t *dropped[LIST_STRIPES];
+    int any = 0;
+    for (int i = 0; i < LIST_STRIPES; i++) {
+        retired[i] = __atomic_exchange_n(&li->stripes[i].retired, (list_retired *) 0x0, __ATOMIC_SEQ_CST);
+        dropped[i] = __atomic_exchange_n(&li->stripes[i].dropped, (list_t *) 0x0, __ATOMIC_SEQ_CST);
+        any |= (retired[i] || dropped[i]);
+    }
+
+    for (int flip = 0; any && flip < 2; flip++) {
+        int phase = __atomic_fetch_xor(&li->phase, 1, __ATOMIC_SEQ_CST);
+        for (int i = 0; i < LIST_STRIPES; i++) {
+            int spins = 0;
+            while (__atomic_load_n(&li->stripes[i].readers[phase], __ATOMIC_SEQ_CST)) spincmp_1(&spins);
+        }
+    }
+
+    for (int i = 0; i < LIST_STRIPES; i++) {
+        int freed = 0;
+        while (retired[i] != 0x0) {
+            list_retired *tmp = retired[i];
+            retired[i] = tmp->next;
+            free(tmp->array);
+            if (tmp->node) nodereleasecmp_1(0x0, tmp->node); // the pool is not shared between threads
+            free(tmp);
+            freed++;
+        }
+        while (dropped[i] != 0x0) {
+            list_t *tmp = dropped[i];
+            dropped[i] = tmp->dropped;
+            nodereleasecmp_1(0x0, tmp);
+            freed++;
+        }
+        __atomic_fetch_sub(&li->stripes[i].retired_count, freed, __ATOMIC_RELAXED);
+    }
+    spinunlockcmp_1(&li->reclaim);
+}
+
+// every call that reaches nodes of a thread-safe or lock-free list runs between these two, returns the side it counts on (-1: neither mode);
+// the counts are striped per thread, so calls on different threads do not write the same cache line
+int safeentercmp_1(list_ptr *li) {
+    if (!li || (!li->threadsafe && !li->lockfree)) return -1;
+    int phase = __atomic_load_n(&li->phase, __ATOMIC_SEQ_CST);
+    __atomic_fetch_add(&li->stripes[stripecmp_1()].readers[phase], 1, __ATOMIC_SEQ_CST);
+    return phase;
+}
+
+void safeleavecmp_1(list_ptr *li, int phase) {
+    if (phase < 0) return;
+    list_stripe *stripe = &li->stripes[stripecmp_1()];
+    __atomic_fetch_sub(&stripe->readers[phase], 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&stripe->retired_count, __ATOMIC_RELAXED) >= LIST_RETIRE_BATCH) nodereclaimcmp_2(li);
+}
+
+// frees everything retired, no other thread may use the list
+void nodereclaimcmp_1(list_ptr *li) {
+    if (!li->stripes) return;
+
+    for (int i = 0; i < LIST_STRIPES; i++) {
+        list_stripe *stripe = &li->stripes[i];
+        while (stripe->retired != 0x0) {
+            list_retired *tmp = stripe->retired;
+            stripe->retired = tmp->next;
+            free(tmp->array);
+            if (tmp->node) nodereleasecmp_1(li, tmp->node);
+            free(tmp);
+        }
+        while (stripe->dropped != 0x0) {
+            list_t *tmp = stripe->dropped;
+            stripe->dropped = tmp->dropped;
+            nodereleasecmp_1(li, tmp);
+        }
+        stripe->retired_count = 0;
+    }
+}
+
+// counters and retired lists for the concurrent modes, allocated on first use
+int stripeallocatecmp_1(list_ptr *li) {
+    if (li->stripes) return 1;
+
+    li->stripes = (list_stripe *) aligned_alloc(sizeof(list_stripe), LIST_STRIPES * sizeof(list_stripe));
+    if (!li->stripes) return 0;
+    memset(li->stripes, 0, LIST_STRIPES * sizeof(list_stripe));
+    return 1;
+}
+
+// nodegrowcmp_1 for thread-safe lists: the old array is retired instead of freed
+int nodegrowcmp_2(list_ptr *li, list_t *current, int size) {
+    if (size <= current->capacity) return 1;
+
+    int owned = nodeownscmp_1(current);
+    list_retired *retired = (owned) ? (list_retired *) malloc(sizeof(list_retired)) : 0x0;
+    if (owned && !retired) return 0;
+
+    int *new_array = (int *) malloc(size * sizeof(int));
+    if (!new_array) {
+        free(retired);
+        return 0;
+    }
+    memcpy(new_array, current->array, current->size * sizeof(int));
+
+    int *old_array = current->array;
+    __atomic_store_n(&current->array, new_array, __ATOMIC_RELEASE);
+    current->capacity = size;
+    current->flags &= ~LIST_ADOPTED;
+    current->generation++;
+    if (owned) noderetirecmp_1(li, retired, 0x0, old_array);
+    return 1;
+}
+
+
+int unrolledreservecmp_1(list_ptr *li, int extra) {
+    if (li->length + extra + 1 <= li->directory_capacity) return 1;
+
+    int capacity = (li->length + extra + 1) * 2;
+    list_t **directory = (list_t **) realloc(li->directory, capacity * sizeof(list_t *));
+    if (!directory) return 0;
+    li->directory = directory;
+
+    int *cumulative = (int *) realloc(li->cumulative, capacity * sizeof(int));
+    if (!cumulative) return 0;
+    li->cumulative = cumulative;
+
+    li->directory_capacity = capacity;
+    return 1;
+}
+
+int unrolledindexcmp_1(list_ptr *li) {
+    if (li->indexed) return 1;
+    if (!unrolledreservecmp_1(li, 0)) return 0;
+
+    int count = 0;
+    int total = 0;
+    for (list_t *current = li->head; current != 0x0; current = current->prev) { // head to tail
+        li->directory[count] = current;
+        li->cumulative[count++] = total;
+        total += current->size;
+    }
+
+    li->cumulative[count] = total;
+    li->indexed = 1;
+    return 1;
+}
+
+// resolves index (negative: from the tail) starting from the head, the tail or the finger, whichever is closest
+list_t *nodelocatecmp_1(list_ptr *li, int index) {
+    if (index < 0) index += li->length;
+    if (index < 0 || index >= li->length) return 0x0;
+    if (li->indexed) return li->directory[index];
+
+    list_t *current = li->head;
+    int count = 0;
+
+    if (li->length - 1 - index < index) {
+        current = li->tail;
+        count = li->length - 1;
+    }
+    if (li->finger && abs(li->finger_index - index) < abs(count - index)) {
+        current = li->finger;
+        count = li->finger_index;
+    }
+
+    for (; count < index; count++) current = current->prev; // towards the tail
+    for (; count > index; count--) current = current->nxt; // towards the head
+
+    li->finger = current;
+    li->finger_index = index;
+    return current;
+}
+
+int unrolledlocatecmp_1(list_ptr *li, int position) {
+    int left = 0;
+    int right = li->length - 1;
+
+    while (left < right) { // last node starting at or before position
+        int mid = (left + right + 1) / 2;
+        if (li->cumulative[mid] <= position) left = mid; else right = mid - 1;
+    }
+
+    return left;
+}
+
+void unrolledshiftcmp_1(list_ptr *li, int first, int last, int delta) {
+    for (int i = first; i <= last; i++) li->cumulative[i + 1] = li->cumulative[i] + li->directory[i]->size;
+    for (int i = last + 2; i <= li->length; i++) li->cumulative[i] += delta;
+}
+
+void unrolledlinkcmp_1(list_ptr *li, int k, list_t *a) {
+    list_t *current = li->directory[k];
+
+    a->nxt = current;
+    a->prev = current->prev;
+    if (current->prev == 0x0) li->tail = a; else current->prev->nxt = a;
+    current->prev = a;
+
+    li->finger = 0x0;
+    memmove(li->directory + k + 2, li->directory + k + 1, (li->length - k - 1) * sizeof(list_t *));
+    memmove(li->cumulative + k + 2, li->cumulative + k + 1, (li->length - k) * sizeof(int));
+    li->directory[k + 1] = a;
+    li->length++;
+}
+
+void unrolledunlinkcmp_1(list_ptr *li, int k) {
+    list_t *current = li->directory[k];
+
+    if (current->nxt == 0x0) li->head = current->prev; else current->nxt->prev = current->prev;
+    if (current->prev == 0x0) li->tail = current->nxt; else current->prev->nxt = current->nxt;
+
+    li->finger = 0x0;
+    memmove(li->directory + k, li->directory + k + 1, (li->length - k - 1) * sizeof(list_t *));
+    memmove(li->cumulative + k + 1, li->cumulative + k + 2, (li->length - k - 1) * sizeof(int));
+    li->length--;
+    nodereleasecmp_1(li, current);
+}
+
+void unrolledmergecmp_1(list_ptr *li, int k) {
+    if (k >= li->length || li->length < 2 || li->directory[k]->size >= li->unrolled / 4) return;
+
+    int m = (k + 1 < li->length) ? k : k - 1; // merge with the neighbour towards the tail when there is one
+    list_t *a = li->directory[m];
+    list_t *b = li->directory[m + 1];
+    int total = a->size + b->size;
+    nodetouchcmp_1(a);
+    nodetouchcmp_1(b);
+
+    if (total <= li->unrolled) {
+        if (!nodegrowcmp_1(a, total)) return;
+        memcpy(a->array + a->size, b->array, b->size * sizeof(int));
+        a->size = total;
+        b->size = 0;
+        unrolledunlinkcmp_1(li, m + 1);
+        unrolledshiftcmp_1(li, m, m, 0);
+        return;
+    }
+
+    int half = total / 2; // too large to merge: rebalance the pair instead
+    if (a->size < half) {
+        int moved = half - a->size;
+        if (!nodegrowcmp_1(a, half)) return;
+        memcpy(a->array + a->size, b->array, moved * sizeof(int));
+        memmove(b->array, b->array + moved, (b->size - moved) * sizeof(int));
+        a->size = half;
+        b->size -= moved;
+    } else {
+        int moved = a->size - half;
+        if (!nodegrowcmp_1(b, b->size + moved)) return;
+        memmove(b->array + moved, b->array, b->size * sizeof(int));
+        memcpy(b->array, a->array + half, moved * sizeof(int));
+        a->size = half;
+        b->size += moved;
+    }
+    unrolledshiftcmp_1(li, m, m + 1, 0);
+}
+
+
+// returns 1 when the node was resized
+int writecmp_1(list_t *current, int start, int end, int *input, int reserved) {
+    list_index *index = current->index;
+    int size = current->size;
+
+    if (start == -1 && end == -1) {
+        if (size <= 0) return 0;
+        nodetouchcmp_2(current);
+
+        if (index) indexremovecmp_1(index, current->array[size - 1], size - 1);
+        current->array[size - 1] = input[0];
+        if (index && !indexinsertcmp_1(index, input[0], size - 1)) indexdropcmp_1(current);
+        return 0;
+    }
+
+    if (start < 0 || (end >= size && reserved < 0)) return 0;
+    nodetouchcmp_2(current);
+
+    if (index && 2 * (end - start + 1) > size) { // large write: rebuilding beats updating slot by slot
+        indexdropcmp_1(current);
+        index = 0x0;
+    }
+    if (index) for (int i = start; i <= end && i < size; i++) indexremovecmp_1(index, current->array[i], i);
+
+    int resized = 0;
+    if (end >= size) {
+        if (!nodegrowcmp_1(current, nodegrowthcmp_1(current, (end + 1) + reserved))) {
+            if (index) indexdropcmp_1(current);
+            return 0;
+        }
+
+        memset(current->array + (end + 1), 0xFF, reserved * sizeof(int)); // 0xFFFFFFFF
+
+        __atomic_store_n(&current->size, (end + 1) + reserved, __ATOMIC_RELEASE); // after the array, for snapshot readers
+        resized = 1;
+    }
+
+    memcpy(current->array + start, input, (end - start + 1) * sizeof(int));
+
+    if (index) { // written positions, plus any the write appended
+        for (int i = (start < size) ? start : size; i < ((resized) ? current->size : end + 1); i++) {
+            if (!indexinsertcmp_1(index, current->array[i], i)) {
+                indexdropcmp_1(current);
+                break;
+            }
+        }
+    } else if (current->flags & LIST_HASHED) {
+        indexbuildcmp_1(current);
+    }
+    return resized;
+}
+
+// returns 1 when the node was resized; retain only lowers size, for thread-safe lists whose readers may hold the array
+int erasecmp_1(list_t *current, int start, int end, int free_memory, int retain) {
+    if (start == -1 && end == -1) start = end = current->size - 1;
+    if (start < 0 || end >= current->size) return 0;
+    nodetouchcmp_2(current);
+
+    list_index *index = current->index;
+    if (index && end == current->size - 1) { // nothing shifts: only the erased positions change
+        for (int i = start; i <= end; i++) indexremovecmp_1(index, current->array[i], i);
+        for (int i = start; i <= end && !free_memory; i++) indexputcmp_1(index, 0xFFFFFFFF, i);
+    } else {
+        indexdropcmp_1(current); // rebuilt on the next hash lookup
+    }
+
+    int size = current->size - (end - start + 1);
+    memmove(current->array + start, current->array + (end + 1), (current->size - (end + 1)) * sizeof(int));
+
+    if (!free_memory) { // size stays, the vacated end reads 0xFFFFFFFF
+        memset(current->array + size, 0xFF, (end - start + 1) * sizeof(int));
+        return 0;
+    }
+    if (retain) __atomic_store_n(&current->size, size, __ATOMIC_RELEASE); else nodeshrinkcmp_1(current, size);
+    return 1;
+}
+
+int findcmp_1(list_t *current, int start, int end, int *target, int target_size, int option) {
+    if (target && nodeexcludescmp_1(current, target, target_size)) return 0xFFFFFFFF;
+    if (option == 0 && start <= end && (current->flags & LIST_SORTED)) option = 1; // same first match, in log time
+
+    switch (option) {
+        case 0:
+            return linearsearchcmp_1(current, start, end, target, target_size);
+        case 1:
+            return binarysearchcmp_1(current, start, end, target, target_size);
+        case 2:
+            if (!(current->flags & LIST_HASHED) || (!current->index && !indexbuildcmp_1(current))) {
+                return linearsearchcmp_1(current, start, end, target, target_size);
+            }
+            return indexfindcmp_1(current, start, end, target, target_size);
+        default:
+            return 0xFFFFFFFF;
+    }
+}
+
+void sortcmp_1(list_t *current, int option) {
+    if (option < 0 || option > 3) return;
+    nodetouchcmp_1(current);
+
+    switch (option) {
+        case 0:
+            bubblesortcmp_1(current);
+            break;
+        case 1:
+            mergesortcmp_2(current->array, current->size);
+            break;
+        case 2:
+            radixsortcmp_1(current->array, current->size);
+            break;
+        case 3:
+            introsortcmp_2(current->array, current->size);
+            break;
+    }
+
+    nodesortedcmp_1(current);
+}
+
+// k-way merge through a loser tree: tree[0] holds the winning source, tree[1..k-1] the losers of each match
+void losertreecmp_1(int *tree, long long *key, int k, int s) {
+    for (int t = (s + k) / 2; t > 0; t /= 2) {
+        if (key[s] > key[tree[t]]) {
+            int temp = s;
+            s = tree[t];
+            tree[t] = temp;
+        }
+    }
+    tree[0] = s;
+}
+
+// returns 0 when out of memory, output is left untouched
+int losertreecmp_2(list_t **nodes, int k, int *output) {
+    int *tree = (int *) malloc(k * sizeof(int));
+    int *cursor = (int *) malloc(k * sizeof(int));
+    long long *key = (long long *) malloc((k + 1) * sizeof(long long)); // key[k]: sentinel beating every source
+    if (!tree || !cursor || !key) {
+        free(tree);
+        free(cursor);
+        free(key);
+        return 0;
+    }
+
+    int total = 0;
+    key[k] = LLONG_MIN;
+    for (int i = 0; i < k; i++) {
+        tree[i] = k;
+        cursor[i] = 0;
+        key[i] = (nodes[i]->size > 0) ? nodes[i]->array[0] : LLONG_MAX;
+        total += nodes[i]->size;
+    }
+    for (int i = k - 1; i >= 0; i--) losertreecmp_1(tree, key, k, i);
+
+    for (int i = 0; i < total; i++) {
+        int w = tree[0];
+        output[i] = (int) key[w];
+        key[w] = (++cursor[w] < nodes[w]->size) ? nodes[w]->array[cursor[w]] : LLONG_MAX;
+        losertreecmp_1(tree, key, k, w);
+    }
+
+    free(tree);
+    free(cursor);
+    free(key);
+    return 1;
+}
+
+typedef struct {
+    int *items; // node positions, ascending by size
+    long top; // thieves take from here
+    long bottom; // the owner takes from here
+} list_deque;
+
+typedef struct {
+    list_t **nodes;
+    list_deque *deques;
+    int workers;
+    void (*fn)(list_t *, int, void *);
+    void *ctx;
+} list_job;
+
+typedef struct {
+    list_job *job;
+    int id;
+} list_worker;
+
+// owner end, chase-lev: returns -1 once the deque is empty
+int dequetakecmp_1(list_deque *d) {
+    long b = __atomic_load_n(&d->bottom, __ATOMIC_RELAXED) - 1;
+    __atomic_store_n(&d->bottom, b, __ATOMIC_SEQ_CST);
+    long t = __atomic_load_n(&d->top, __ATOMIC_SEQ_CST);
+
+    if (t > b) {
+        __atomic_store_n(&d->bottom, b + 1, __ATOMIC_RELAXED);
+        return -1;
+    }
+
+    int item = d->items[b];
+    if (t == b) { // last item: race the thieves for it
+        if (!__atomic_compare_exchange_n(&d->top, &t, t + 1, 0, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) item = -1;
+        __atomic_store_n(&d->bottom, b + 1, __ATOMIC_RELAXED);
+    }
+    return item;
+}
+
+// thief end: returns -1 when empty, -2 when another thread won the race
+int dequestealcmp_1(list_deque *d) {
+    long t = __atomic_load_n(&d->top, __ATOMIC_SEQ_CST);
+    long b = __atomic_load_n(&d->bottom, __ATOMIC_SEQ_CST);
+    if (t >= b) return -1;
+
+    int item = d->items[t];
+    if (!__atomic_compare_exchange_n(&d->top, &t, t + 1, 0, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) return -2;
+    return item;
+}
+
+void *parallelcmp_1(void *arg) {
+    list_worker *worker = (list_worker *) arg;
+    list_job *job = worker->job;
+
+    int item;
+    while ((item = dequetakecmp_1(&job->deques[worker->id])) >= 0) job->fn(job->nodes[item], item, job->ctx);
+
+    for (int busy = 1; busy;) { // own deque is empty: steal until every deque is
+        busy = 0;
+        for (int i = 1; i < job->workers; i++) {
+            list_deque *victim = &job->deques[(worker->id + i) % job->workers];
+
+            while ((item = dequestealcmp_1(victim)) != -1) {
+                if (item == -2) {
+                    busy = 1;
+                    continue;
+                }
+                job->fn(job->nodes[item], item, job->ctx);
+                busy = 1;
+            }
+        }
+    }
+    return 0x0;
+}
+
+int parallelcmp_2(const void *a, const void *b) {
+    long long x = *(const long long *) a;
+    long long y = *(const long long *) b;
+    return (x < y) - (x > y);
+}
+
+// runs fn(node, position, ctx) over every node on threads workers (the caller included)
+void parallelcmp_3(list_t **nodes, int count, void (*fn)(list_t *, int, void *), void *ctx, int threads) {
+    if (threads > count) threads = count;
+
+    list_deque *deques = (threads > 1) ? (list_deque *) calloc(threads, sizeof(list_deque)) : 0x0;
+    long long *load = (deques) ? (long long *) calloc(threads, sizeof(long long)) : 0x0;
+    long long *order = (load) ? (long long *) malloc(count * sizeof(long long)) : 0x0;
+    int *items = (order) ? (int *) malloc(count * sizeof(int)) : 0x0;
+    int *owner = (items) ? (int *) malloc(count * sizeof(int)) : 0x0;
+    list_worker *workers = (owner) ? (list_worker *) malloc(threads * sizeof(list_worker)) : 0x0;
+    pthread_t *handles = (workers) ? (pthread_t *) malloc(threads * sizeof(pthread_t)) : 0x0;
+
+    if (!handles) {
+        for (int i = 0; i < count; i++) fn(nodes[i], i, ctx);
+
+        free(deques);
+        free(load);
+        free(order);
+        free(items);
+        free(owner);
+        free(workers);
+        return;
+    }
+
+    // balance by size: largest node first, each to the least loaded worker
+    for (int i = 0; i < count; i++) order[i] = ((long long) nodes[i]->size << 32) | i;
+    qsort(order, count, sizeof(long long), parallelcmp_2);
+
+    for (int i = 0; i < count; i++) {
+        int position = (int) (order[i] & 0xFFFFFFFF);
+        int least = 0;
+        for (int w = 1; w < threads; w++) if (load[w] < load[least]) least = w;
+
+        owner[position] = least;
+        load[least] += nodes[position]->size + 1;
+        deques[least].bottom++;
+    }
+
+    long offset = 0;
+    for (int w = 0; w < threads; w++) {
+        deques[w].items = items + offset;
+        offset += deques[w].bottom;
+        deques[w].bottom = 0;
+    }
+    for (int i = count - 1; i >= 0; i--) { // ascending by size, so each owner starts with its largest
+        int position = (int) (order[i] & 0xFFFFFFFF);
+        list_deque *d = &deques[owner[position]];
+        d->items[d->bottom++] = position;
+    }
+
+    list_job job = {nodes, deques, threads, fn, ctx};
+    int started = 1;
+    for (int w = 0; w < threads; w++) {
+        workers[w].job = &job;
+        workers[w].id = w;
+    }
+    while (started < threads && pthread_create(&handles[started], 0x0, parallelcmp_1, &workers[started]) == 0) started++;
+
+    parallelcmp_1(&workers[0]); // deques of workers that failed to start are stolen
+    for (int w = 1; w < started; w++) pthread_join(handles[w], 0x0);
+
+    free(deques);
+    free(load);
+    free(order);
+    free(items);
+    free(owner);
+    free(workers);
+    free(handles);
+}
+
+void sortallcmp_1(list_t *current, int position, void *ctx) {
+    (void) position;
+    sortcmp_1(current, *(int *) ctx);
+}
+
+typedef struct {
+    int *target;
+    int target_size;
+    int **offsets; // per node: matching element indexes
+    int *found; // per node: number of matches
+} list_find_job;
+
+void findallcmp_1(list_t *current, int position, void *ctx) {
+    list_find_job *job = (list_find_job *) ctx;
+    int *offsets = 0x0;
+    int found = 0;
+    int capacity = 0;
+
+    nodesummarycmp_1(current); // one extra pass the first time, skipped nodes cost O(1) afterward
+    if (nodeexcludescmp_1(current, job->target, job->target_size)) {
+        job->offsets[position] = 0x0;
+        job->found[position] = 0;
+        return;
+    }
+
+    for (int start = 0; start < current->size;) {
+        int hit = linearsearchcmp_1(current, start, current->size - 1, job->target, job->target_size);
+        if (hit == 0xFFFFFFFF) break;
+
+        if (found == capacity) {
+            capacity = (capacity) ? capacity * 2 : 8;
+            int *grown = (int *) realloc(offsets, capacity * sizeof(int));
+            if (!grown) break;
+            offsets = grown;
+        }
+        offsets[found++] = hit;
+        start = hit + 1;
+    }
+
+    job->offsets[position] = offsets;
+    job->found[position] = found;
+}
+
+typedef struct {
+    int *target;
+    int target_size;
+    int option;
+    int *result;
+} list_find_each_job;
+
+void findeachcmp_1(list_t *current, int position, void *ctx) {
+    list_find_each_job *job = (list_find_each_job *) ctx;
+    if (current->size == 0) {
+        job->result[position] = 0xFFFFFFFF;
+        return;
+    }
+
+    if (!job->option) nodesummarycmp_1(current); // a linear search reads the whole array anyway
+    job->result[position] = findcmp_1(current, 0, current->size - 1, job->target, job->target_size, job->option);
+}
+
+typedef struct {
+    int start;
+    int end;
+    int *input;
+    int reserved;
+} list_write_each_job;
+
+void writeeachcmp_1(list_t *current, int position, void *ctx) {
+    (void) position;
+    list_write_each_job *job = (list_write_each_job *) ctx;
+    writecmp_1(current, job->start, job->end, job->input, job->reserved);
+}
+
+// list_push on a thread-safe list: locks the current end node, then the list for head and tail
+void safepushcmp_1(list_ptr *li, int location, list_t *a) {
+    list_t **end = (location == FRONT) ? &li->head : &li->tail;
+    int spins = 0;
+
+    while (1) {
+        list_t *current = __atomic_load_n(end, __ATOMIC_ACQUIRE);
+        if (current) spinlockcmp_1(&current->lock);
+        spinlockcmp_1(&li->lock);
+
+        if (*end == current) {
+            a->nxt = (location == FRONT) ? 0x0 : current;
+            a->prev = (location == FRONT) ? current : 0x0;
+
+            if (!current) __atomic_store_n((location == FRONT) ? &li->tail : &li->head, a, __ATOMIC_RELEASE);
+            else if (location == FRONT) __atomic_store_n(&current->nxt, a, __ATOMIC_RELEASE);
+            else __atomic_store_n(&current->prev, a, __ATOMIC_RELEASE);
+            __atomic_store_n(end, a, __ATOMIC_RELEASE);
+
+            __atomic_fetch_add(&li->length, 1, __ATOMIC_RELAXED);
+            __atomic_store_n(&li->indexed, 0, __ATOMIC_RELAXED);
+            spinunlockcmp_1(&li->lock);
+            if (current) spinunlockcmp_1(&current->lock);
+            return;
+        }
+
+        spinunlockcmp_1(&li->lock);
+        if (current) spinunlockcmp_1(&current->lock);
+        spincmp_1(&spins);
+    }
+}
+
+// grows *copy to hold size elements, for pops that copy the node out before they take it
+int takebuffercmp_1(int **copy, int *capacity, int size) {
+    if (*copy && size <= *capacity) return 1;
+
+    int *buffer = (int *) realloc(*copy, ((size > 0) ? size : 1) * sizeof(int));
+    if (!buffer) return 0;
+    *copy = buffer;
+    *capacity = size;
+    return 1;
+}
+
+// list_pop on a thread-safe list: locks the end node and its neighbour, then the list; nothing is popped when the node cannot be retired
+// copy => 0x0: the array is dropped | receives a copy of it, made under the node's lock (nothing is popped if it cannot be allocated)
+void safepopcmp_1(list_ptr *li, int location, int **copy, int *size) {
+    list_t **end = (location == FRONT) ? &li->head : &li->tail;
+    list_retired *retired = (list_retired *) malloc(sizeof(list_retired));
+    if (!retired) return;
+    int capacity = 0, spins = 0;
+
+    while (1) {
+        list_t *current = __atomic_load_n(end, __ATOMIC_ACQUIRE);
+        if (!current) break;
+        spinlockcmp_1(&current->lock);
+        if (copy && !takebuffercmp_1(copy, &capacity, current->size)) {
+            spinunlockcmp_1(&current->lock);
+            break;
+        }
+
+        list_t *next = (location == FRONT) ? current->prev : current->nxt; // becomes the new end
+        if (next && !spintrylockcmp_1(&next->lock)) {
+            spinunlockcmp_1(&current->lock);
+            spincmp_1(&spins);
+            continue;
+        }
+        spinlockcmp_1(&li->lock);
+
+        int popped = (*end == current);
+        if (popped) {
+            if (copy) {
+                memcpy(*copy, current->array, current->size * sizeof(int));
+                *size = current->size;
+            }
+            if (!next) __atomic_store_n((location == FRONT) ? &li->tail : &li->head, (list_t *) 0x0, __ATOMIC_RELEASE);
+            else if (location == FRONT) __atomic_store_n(&next->nxt, (list_t *) 0x0, __ATOMIC_RELEASE);
+            else __atomic_store_n(&next->prev, (list_t *) 0x0, __ATOMIC_RELEASE);
+            __atomic_store_n(end, next, __ATOMIC_RELEASE);
+
+            __atomic_fetch_sub(&li->length, 1, __ATOMIC_RELAXED);
+            __atomic_store_n(&li->indexed, 0, __ATOMIC_RELAXED);
+        }
+
+        spinunlockcmp_1(&li->lock);
+        if (next) spinunlockcmp_1(&next->lock);
+        spinunlockcmp_1(&current->lock);
+
+        if (popped) {
+            noderetirecmp_1(li, retired, current, 0x0);
+            return;
+        }
+        spincmp_1(&spins);
+    }
+
+    free(retired);
+    if (copy) {
+        free(*copy);
+        *copy = 0x0;
+    }
+}
+
+// iterator_insert on a thread-safe list: locks the node and its tail-side neighbour (the list too, at the tail)
+void safeinsertcmp_1(list_ptr *li, list_t *points, list_t *a) {
+    int spins = 0;
+
+    while (1) {
+        spinlockcmp_1(&points->lock);
+        list_t *prev = points->prev;
+        if (prev && !spintrylockcmp_1(&prev->lock)) {
+            spinunlockcmp_1(&points->lock);
+            spincmp_1(&spins);
+            continue;
+        }
+
+        a->nxt = points;
+        a->prev = prev;
+
+        if (prev) {
+            __atomic_store_n(&prev->nxt, a, __ATOMIC_RELEASE);
+        } else {
+            spinlockcmp_1(&li->lock);
+            __atomic_store_n(&li->tail, a, __ATOMIC_RELEASE);
+            spinunlockcmp_1(&li->lock);
+        }
+        __atomic_store_n(&points->prev, a, __ATOMIC_RELEASE);
+
+        __atomic_fetch_add(&li->length, 1, __ATOMIC_RELAXED);
+        __atomic_store_n(&li->indexed, 0, __ATOMIC_RELAXED);
+        if (prev) spinunlockcmp_1(&prev->lock);
+        spinunlockcmp_1(&points->lock);
+        return;
+    }
+}
+
+// iterator_delete on a thread-safe list: locks the node, the one removed and the one behind it; nothing is deleted when the node cannot be retired
+void safedeletecmp_1(list_ptr *li, list_t *points) {
+    list_retired *retired = (list_retired *) malloc(sizeof(list_retired));
+    if (!retired) return;
+    int spins = 0;
+
+    while (1) {
+        spinlockcmp_1(&points->lock);
+        list_t *tmp = points->prev;
+        if (!tmp) {
+            spinunlockcmp_1(&points->lock);
+            free(retired);
+            return;
+        }
+        if (!spintrylockcmp_1(&tmp->lock)) {
+            spinunlockcmp_1(&points->lock);
+            spincmp_1(&spins);
+            continue;
+        }
+
+        list_t *prev = tmp->prev;
+        if (prev && !spintrylockcmp_1(&prev->lock)) {
+            spinunlockcmp_1(&tmp->lock);
+            spinunlockcmp_1(&points->lock);
+            spincmp_1(&spins);
+            continue;
+        }
+
+        if (prev) {
+            __atomic_store_n(&prev->nxt, points, __ATOMIC_RELEASE);
+            __atomic_store_n(&points->prev, prev, __ATOMIC_RELEASE);
+        } else { // tmp is the tail node
+            spinlockcmp_1(&li->lock);
+            __atomic_store_n(&points->prev, (list_t *) 0x0, __ATOMIC_RELEASE);
+            __atomic_store_n(&li->tail, points, __ATOMIC_RELEASE);
+            spinunlockcmp_1(&li->lock);
+        }
+
+        __atomic_fetch_sub(&li->length, 1, __ATOMIC_RELAXED);
+        __atomic_store_n(&li->indexed, 0, __ATOMIC_RELAXED);
+        if (prev) spinunlockcmp_1(&prev->lock);
+        spinunlockcmp_1(&tmp->lock);
+        spinunlockcmp_1(&points->lock);
+        noderetirecmp_1(li, retired, tmp, 0x0);
+        return;
+    }
+}
+
+/*
+ * Lock-free mode (Sundell and Tsigas' deque): the nodes hang between two anchors, prev links (towards the tail) are
+ * the list itself and nxt links (towards the head) are hints repaired by whoever finds them stale. A node is deleted
+ * by marking the lowest bit of both its links, then unlinked, helped along by any thread that runs into it.
+ * Every link counts on the node it points to; once a deleted node has none left, no thread can reach it anymore
+ * except those already running, so it is dropped into the retire scheme and freed after they have returned.
+ */
+
+list_t *linknodecmp_1(list_t *link) {
+    return (list_t *) ((uintptr_t) link & ~(uintptr_t) 1);
+}
+
+int linkmarkedcmp_1(list_t *link) {
+    return (int) ((uintptr_t) link & 1);
+}
+
+list_t *linkmarkcmp_1(list_t *current) {
+    return (list_t *) ((uintptr_t) current | 1);
+}
+
+list_t *linkloadcmp_1(list_t **link) {
+    return __atomic_load_n(link, __ATOMIC_SEQ_CST);
+}
+
+// the node a link points to, 0x0 when the link is marked
+list_t *linkreadcmp_1(list_t **link) {
+    list_t *current = linkloadcmp_1(link);
+    return (linkmarkedcmp_1(current)) ? 0x0 : current;
+}
+
+void linksetmarkcmp_1(list_t **link) {
+    list_t *current = linkloadcmp_1(link);
+    while (!linkmarkedcmp_1(current) && !__atomic_compare_exchange_n(link, &current, linkmarkcmp_1(current), 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST));
+}
+
+// takes one more link on current, unless it has none left (it is then dropped and must not be linked again)
+int linkholdcmp_1(list_t *current) {
+    if (current->flags & LIST_ANCHOR) return 1;
+
+    int links = __atomic_load_n(&current->links, __ATOMIC_SEQ_CST);
+    do {
+        if (!links) return 0;
+    } while (!__atomic_compare_exchange_n(&current->links, &links, links + 1, 1, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST));
+    return 1;
+}
+
+// holds the first node from current on that is not dropped, walking towards the head or the tail (the anchors always hold)
+list_t *linkholdcmp_2(list_t *current, int location) {
+    while (!linkholdcmp_1(current)) current = linknodecmp_1(linkloadcmp_1((location == FRONT) ? &current->nxt : &current->prev));
+    return current;
+}
+
+void linkdropcmp_1(list_t *current, list_t **pending) {
+    if (!current || (current->flags & LIST_ANCHOR)) return;
+    if (__atomic_sub_fetch(&current->links, 1, __ATOMIC_SEQ_CST)) return;
+    current->dropped = *pending;
+    *pending = current;
+}
+
+// gives a link back; a node left without any is dropped, and so is every node only its own links kept
+void linkreleasecmp_1(list_ptr *li, list_t *current) {
+    list_t *pending = 0x0;
+    linkdropcmp_1(current, &pending);
+
+    while (pending != 0x0) { // a node without links is deleted and nobody writes its links anymore
+        list_t *tmp = pending;
+        pending = tmp->dropped;
+        linkdropcmp_1(linknodecmp_1(linkloadcmp_1(&tmp->nxt)), &pending);
+        linkdropcmp_1(linknodecmp_1(linkloadcmp_1(&tmp->prev)), &pending);
+        nodedropcmp_1(li, tmp);
+    }
+}
+
+// sets a link only the calling thread writes (a node not pushed yet, or its own popped node); desired's node is already held
+void linkstorecmp_1(list_ptr *li, list_t **link, list_t *desired) {
+    list_t *current = linkloadcmp_1(link);
+    __atomic_store_n(link, desired, __ATOMIC_SEQ_CST);
+    linkreleasecmp_1(li, linknodecmp_1(current));
+}
+
+// swings a shared link, moving its count from the old node to the new one (same node: only the mark changes)
+int linkswapcmp_1(list_ptr *li, list_t **link, list_t *expected, list_t *desired) {
+    list_t *from = linknodecmp_1(expected), *to = linknodecmp_1(desired);
+    if (from == to) return __atomic_compare_exchange_n(link, &expected, desired, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+    if (!linkholdcmp_1(to)) return 0; // dropped meanwhile, the caller reads the links again
+
+    if (!__atomic_compare_exchange_n(link, &expected, desired, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)) {
+        linkreleasecmp_1(li, to);
+        return 0;
+    }
+    linkreleasecmp_1(li, from);
+    return 1;
+}
+
+void lockfreedeletecmp_1(list_ptr *li, list_t *current);
+
+// points current's head-side hint at the live node in front of it, starting the search at prev; returns that node
+list_t *lockfreehintcmp_1(list_ptr *li, list_t *prev, list_t *current) {
+    int stale = 1, spins = 0;
+
+    while (1) {
+        list_t *prev2 = linkreadcmp_1(&prev->prev);
+        if (!prev2) { // prev is being deleted, step back past it
+            if (!stale) {
+                lockfreedeletecmp_1(li, prev);
+                stale = 1;
+            }
+            prev = linknodecmp_1(linkloadcmp_1(&prev->nxt));
+            continue;
+        }
+
+        list_t *link = linkloadcmp_1(&current->nxt);
+        if (linkmarkedcmp_1(link)) break; // current is being deleted itself
+        if (prev2 != current) {
+            stale = 0;
+            prev = prev2;
+            continue;
+        }
+
+        if (linkswapcmp_1(li, &current->nxt, link, prev)) {
+            if (linkmarkedcmp_1(linkloadcmp_1(&prev->nxt))) continue;
+            break;
+        }
+        spincmp_1(&spins);
+    }
+    return prev;
+}
+
+// unlinks current, whose links are marked, from the node in front of it
+void lockfreedeletecmp_1(list_ptr *li, list_t *current) {
+    linksetmarkcmp_1(&current->nxt);
+
+    list_t *prev = linknodecmp_1(linkloadcmp_1(&current->nxt));
+    list_t *next = linknodecmp_1(linkloadcmp_1(&current->prev));
+    int stale = 1, spins = 0;
+
+    while (prev != next) {
+        if (linkmarkedcmp_1(linkloadcmp_1(&next->prev))) { // next is being deleted too, skip it
+            linksetmarkcmp_1(&next->nxt);
+            next = linknodecmp_1(linkloadcmp_1(&next->prev));
+            continue;
+        }
+
+        list_t *prev2 = linkreadcmp_1(&prev->prev);
+        if (!prev2) {
+            if (!stale) {
+                lockfreedeletecmp_1(li, prev);
+                stale = 1;
+            }
+            prev = linknodecmp_1(linkloadcmp_1(&prev->nxt));
+            continue;
+        }
+        if (prev2 != current) {
+            stale = 0;
+            prev = prev2;
+            continue;
+        }
+
+        if (linkswapcmp_1(li, &prev->prev, current, next)) break;
+        spincmp_1(&spins);
+    }
+}
+
+// after a pop, points the popped node's links past deleted nodes, so deleted nodes never keep each other
+void lockfreedetachcmp_1(list_ptr *li, list_t *current) {
+    while (1) {
+        list_t *prev = linknodecmp_1(linkloadcmp_1(&current->nxt));
+        if (linkmarkedcmp_1(linkloadcmp_1(&prev->prev))) {
+            list_t *prev2 = linkholdcmp_2(linknodecmp_1(linkloadcmp_1(&prev->nxt)), FRONT);
+            linkstorecmp_1(li, &current->nxt, linkmarkcmp_1(prev2));
+            continue;
+        }
+
+        list_t *next = linknodecmp_1(linkloadcmp_1(&current->prev));
+        if (linkmarkedcmp_1(linkloadcmp_1(&next->prev))) {
+            list_t *next2 = linkholdcmp_2(linknodecmp_1(linkloadcmp_1(&next->prev)), BACK);
+            linkstorecmp_1(li, &current->prev, linkmarkcmp_1(next2));
+            continue;
+        }
+        break;
+    }
+}
+
+// links the hint of next back to a, once a is in front of it
+void lockfreehintcmp_2(list_ptr *li, list_t *a, list_t *next) {
+    int spins = 0;
+
+    while (1) {
+        list_t *link = linkloadcmp_1(&next->nxt);
+        if (linkmarkedcmp_1(link) || linkloadcmp_1(&a->prev) != next) break;
+
+        if (linkswapcmp_1(li, &next->nxt, link, a)) {
+            if (linkmarkedcmp_1(linkloadcmp_1(&a->nxt))) lockfreehintcmp_1(li, a, next);
+            break;
+        }
+        spincmp_1(&spins);
+    }
+}
+
+// list_push on a lock-free list: a is linked in with one compare-and-swap on the link in front of it
+void lockfreepushcmp_1(list_ptr *li, int location, list_t *a) {
+    list_t *head = li->anchor[0], *tail = li->anchor[1];
+    a->nxt = 0x0;
+    a->prev = 0x0;
+    a->links = 1; // the pusher's own, given back once a is linked
+    int spins = 0;
+
+    list_t *prev, *next;
+    if (location == FRONT) {
+        prev = head;
+        next = linkloadcmp_1(&head->prev);
+        while (1) {
+            if (linkloadcmp_1(&prev->prev) != next || !linkholdcmp_1(next)) {
+                next = linkloadcmp_1(&prev->prev);
+                continue;
+            }
+            linkstorecmp_1(li, &a->prev, next);
+            linkstorecmp_1(li, &a->nxt, prev);
+            if (linkswapcmp_1(li, &prev->prev, next, a)) break;
+            spincmp_1(&spins);
+        }
+    } else {
+        next = tail;
+        prev = linknodecmp_1(linkloadcmp_1(&tail->nxt));
+        while (1) {
+            if (linkloadcmp_1(&prev->prev) != next || !linkholdcmp_1(prev)) {
+                prev = lockfreehintcmp_1(li, prev, next);
+                continue;
+            }
+            linkstorecmp_1(li, &a->nxt, prev);
+            linkstorecmp_1(li, &a->prev, next);
+            if (linkswapcmp_1(li, &prev->prev, next, a)) break;
+            spincmp_1(&spins);
+        }
+    }
+
+    lockfreehintcmp_2(li, a, next);
+    linkreleasecmp_1(li, a);
+}
+
+// list_pop on a lock-free list: the end node is claimed by marking its tail-side link, then unlinked
+// returns it still held by the caller (0x0: empty); copy as in safepopcmp_1, taken before the node is claimed
+list_t *lockfreepopcmp_1(list_ptr *li, int location, int **copy, int *size) {
+    list_t *head = li->anchor[0], *tail = li->anchor[1], *current;
+    int capacity = 0, spins = 0;
+
+    if (location == FRONT) {
+        while (1) {
+            current = linkloadcmp_1(&head->prev);
+            if (current == tail) break;
+            if (!linkholdcmp_1(current)) continue;
+
+            list_t *link = linkloadcmp_1(&current->prev);
+            if (linkmarkedcmp_1(link)) { // claimed by another pop, help it along
+                lockfreedeletecmp_1(li, current);
+                linkreleasecmp_1(li, current);
+                continue;
+            }
+            if (copy && !takebuffercmp_1(copy, &capacity, current->size)) {
+                linkreleasecmp_1(li, current);
+                break;
+            }
+
+            if (__atomic_compare_exchange_n(&current->prev, &link, linkmarkcmp_1(link), 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)) {
+                lockfreedeletecmp_1(li, current);
+                lockfreehintcmp_1(li, head, linknodecmp_1(linkloadcmp_1(&current->prev)));
+                lockfreedetachcmp_1(li, current);
+                if (copy) {
+                    memcpy(*copy, current->array, current->size * sizeof(int));
+                    *size = current->size;
+                }
+                return current;
+            }
+            linkreleasecmp_1(li, current);
+            spincmp_1(&spins);
+        }
+    } else {
+        current = linknodecmp_1(linkloadcmp_1(&tail->nxt));
+        while (1) {
+            if (linkloadcmp_1(&current->prev) != tail) {
+                current = lockfreehintcmp_1(li, current, tail);
+                continue;
+            }
+            if (current == head) break;
+            if (!linkholdcmp_1(current)) {
+                current = lockfreehintcmp_1(li, current, tail);
+                continue;
+            }
+            if (copy && !takebuffercmp_1(copy, &capacity, current->size)) {
+                linkreleasecmp_1(li, current);
+                break;
+            }
+
+            list_t *link = tail;
+            if (__atomic_compare_exchange_n(&current->prev, &link, linkmarkcmp_1(tail), 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)) {
+                lockfreedeletecmp_1(li, current);
+                lockfreehintcmp_1(li, linknodecmp_1(linkloadcmp_1(&current->nxt)), tail);
+                lockfreedetachcmp_1(li, current);
+                if (copy) {
+                    memcpy(*copy, current->array, current->size * sizeof(int));
+                    *size = current->size;
+                }
+                return current;
+            }
+            linkreleasecmp_1(li, current);
+            spincmp_1(&spins);
+        }
+    }
+
+    if (copy) {
+        free(*copy);
+        *copy = 0x0;
+    }
+    return 0x0;
+}
+
+// carves count nodes out of blocks of up to LIST_BULK_BYTES and pushes them in order; adopt points them into data instead of copying it
+void bulkpushcmp_1(list_ptr *li, int location, int *data, const int *sizes, int count, int adopt, int free_data) {
+    size_t header = (sizeof(list_slab) + 15) & ~(size_t) 15;
+    list_t *first = 0x0, *last = 0x0;
+    long long offset = 0;
+    int pushed = 0;
+    int phase = safeentercmp_1(li); // the end nodes safepushcmp_1 links against may be popped and retired meanwhile
+
+    for (int i = 0; i < count;) {
+        size_t bytes = header;
+        int j = i;
+        while (j < count) { // adopted nodes are only headers and share one block, which owns data
+            size_t stride = (sizeof(list_t) + ((adopt) ? 0 : sizes[j] * sizeof(int)) + 7) & ~(size_t) 7;
+            if (!adopt && j > i && bytes + stride > LIST_BULK_BYTES) break;
+            bytes += stride;
+            j++;
+        }
+
+        list_slab *slab = (list_slab *) malloc(bytes);
+        if (!slab) break;
+        slab->refs = j - i;
+        slab->data = (adopt && free_data) ? data : 0x0;
+        slab->mapped = 0;
+
+        unsigned char *cursor = (unsigned char *) slab + header;
+        for (; i < j; i++) {
+            list_t *a = (list_t *) cursor;
+            a->slab = slab;
+            a->size = sizes[i];
+            a->capacity = sizes[i];
+            a->layout = 0x0;
+            a->index = 0x0;
+            a->lock = 0;
+            a->seq = 0;
+            a->generation = 0;
+
+            if (adopt) {
+                a->array = data + offset;
+                a->inline_capacity = 0;
+                a->pool = -1;
+                a->flags = LIST_ADOPTED;
+                cursor += (sizeof(list_t) + 7) & ~(size_t) 7;
+            } else {
+                a->array = a->payload;
+                a->inline_capacity = sizes[i];
+                a->pool = nodeclasscmp_1(sizes[i]);
+                a->flags = 0;
+                memcpy(a->array, data + offset, sizes[i] * sizeof(int));
+                cursor += (sizeof(list_t) + sizes[i] * sizeof(int) + 7) & ~(size_t) 7;
+            }
+            offset += sizes[i];
+
+            if (li->threadsafe) {
+                safepushcmp_1(li, location, a);
+                continue;
+            }
+            if (li->lockfree) {
+                lockfreepushcmp_1(li, location, a);
+                continue;
+            }
+
+            if (location == FRONT) { // chain runs from first (pushed first) towards the head
+                a->nxt = 0x0;
+                a->prev = last;
+                if (last) last->nxt = a; else first = a;
+            } else {
+                a->nxt = last;
+                a->prev = 0x0;
+                if (last) last->prev = a; else first = a;
+            }
+            last = a;
+            pushed++;
+        }
+    }
+    safeleavecmp_1(li, phase);
+
+    if (!first) return;
+
+    if (location == FRONT) {
+        first->prev = li->head;
+        if (li->head) li->head->nxt = first; else li->tail = first;
+        li->head = last;
+        li->finger_index += pushed;
+    } else {
+        first->nxt = li->tail;
+        if (li->tail) li->tail->prev = first; else li->head = first;
+        li->tail = last;
+    }
+
+    li->length += pushed;
+    li->indexed = 0;
+}
+
+// resolves index from the iterator's node (0..: towards the head | -1..: towards the tail)
+list_t *iteratorlocatecmp_1(iterator_ptr *li, int index) {
+    list_t *current = li->points;
+    int count = (index >= 0) ? 0 : -1;
+
+    while (current != 0x0) {
+        if (count == index) return current;
+
+        current = (index >= 0) ? __atomic_load_n(&current->nxt, __ATOMIC_ACQUIRE) : __atomic_load_n(&current->prev, __ATOMIC_ACQUIRE);
+        count += (index >= 0) ? 1 : -1;
+    }
+
+    return 0x0;
+}
+
+// iteratorlocatecmp_1 inside a safeentercmp_1 section, already left when no node is found
+list_t *iteratorlocatecmp_2(iterator_ptr *li, int index, int *phase) {
+    *phase = safeentercmp_1(li->origin);
+    list_t *current = iteratorlocatecmp_1(li, index);
+    if (!current) safeleavecmp_1(li->origin, *phase);
+    return current;
+}
+
+int iteratorsafecmp_1(iterator_ptr *li) {
+    return li->origin && li->origin->threadsafe;
+}
+
+// span over current->array from start to end (both -1: the last element), empty when out of range
+list_span spancmp_1(list_t *current, int start, int end) {
+    list_span span = {0x0, 0, current, 0};
+    if (!current || start > end) return span;
+
+    if (start == -1 && end == -1) start = end = current->size - 1;
+    if (start < 0 || end >= current->size) return span;
+
+    span.ptr = current->array + start;
+    span.len = end - start + 1;
+    span.generation = current->generation;
+    return span;
+}
+
+/*
+ * Description:
+ *    - As linked list node stored in a non-contiguous memory locations. It might cause cache miss. Frequently traversing is not recommended.
+ *    - Inside node, a contiguous memory block. is provided (array) with useful built in features. You might utilize that instead.
+ *    - 14 Avaliable built in features: push, pop, clear, free, threadsafe, save, write, erase, retrieve, borrow, sort, find, reduce, size
+ *    - Initialize double linked list
+ *    - list_ptr *<variable_name> = list_init();
+ *    - Indexed calls walk from the head, the tail or the last node they resolved, whichever is closest,
+ *      so sequential indexes cost O(1) each.
+ *
+ *
+ * Return: pointer to the list_ptr
+ * Time Complexity: O(1)
+ */
+list_ptr *list_init() {
+    list_ptr *a = (list_ptr *) malloc(sizeof(list_ptr));
+    a->tail = 0x0;
+    a->head = 0x0;
+    a->length = 0;
+    for (int i = 0; i < LIST_POOL_CLASSES; i++) a->pool[i] = 0x0;
+
+    a->unrolled = 0;
+    a->indexed = 0;
+    a->directory_capacity = 0;
+    a->directory = 0x0;
+    a->cumulative = 0x0;
+    a->finger = 0x0;
+    a->finger_index = 0;
+    a->threadsafe = 0;
+    a->lock = 0;
+    a->lockfree = 0;
+    a->anchor[0] = a->anchor[1] = 0x0;
+    a->phase = 0;
+    a->reclaim = 0;
+    a->stripes = 0x0;
+
+    return a;
+}
+
+/*
+ * Adds a new node to the list with the given array.
+ * Parameters:
+ *    - list_ptr => pointer to the list
+ *    - location => FRONT: push to the head | BACK: push to the tail
+ *    - size => input size
+ *    - input => pointer to the input array
+ *
+ * Time Complexity: O(array_size)
+ */
+void list_push(list_ptr *li, int location, int size ,int *input) {
+    if (!li || size <= 0 || !input || (location != FRONT && location != BACK)) return;
+    list_t *a = nodeacquirecmp_1((li->threadsafe || li->lockfree) ? 0x0 : li, size); // the pool is not shared between threads
+    if (!a) return;
+
+    a->size = size;
+    memcpy(a->array, input, size * sizeof(int));
+
+    if (li->threadsafe || li->lockfree) {
+        int phase = safeentercmp_1(li);
+        if (li->lockfree) lockfreepushcmp_1(li, location, a);
+        else safepushcmp_1(li, location, a);
+        safeleavecmp_1(li, phase);
+        return;
+    }
+
+    if (location == FRONT) {
+        a->nxt = 0x0;
+        a->prev = li->head;
+
+        if (li->head != 0x0) li->head->nxt = a; else li->tail = a;
+        li->head = a;
+        li->finger_index++;
+    }
+
+    if (location == BACK) {
+        a->nxt = li->tail;
+        a->prev = 0x0;
+
+        if (li->tail != 0x0) li->tail->prev = a; else li->head = a;
+        li->tail = a;
+    }
+
+    li->length++;
+    li->indexed = 0;
+}
+
+/*
+ * Removes a node from the list.
+ * Parameters:
+ *    - list_ptr => pointer to the list
+ *    - location => FRONT: pop from the head | BACK: pop from the tail
+ *
+ * Time Complexity: O(1)
+ */
+void list_pop(list_ptr *li, int location) {
+    if (!li || (location != FRONT && location != BACK)) return;
+
+    if (li->threadsafe || li->lockfree) {
+        int phase = safeentercmp_1(li);
+        if (li->lockfree) linkreleasecmp_1(li, lockfreepopcmp_1(li, location, 0x0, 0x0));
+        else safepopcmp_1(li, location, 0x0, 0x0);
+        safeleavecmp_1(li, phase);
+        return;
+    }
+
+    if (li->tail == 0x0) return;
+
+    if (location == BACK) {
+        list_t *tmp = li->tail;
+        li->tail = li->tail->nxt;
+    
+        if (li->tail != 0x0) li->tail->prev = 0x0; else li->head = 0x0;
+        if (li->finger == tmp) li->finger = 0x0;
+        nodereleasecmp_1(li, tmp);
+        li->length--;
+        li->indexed = 0;
+
+        return;
+    }
+
+    if (location == FRONT) {
+        list_t *tmp = li->head;
+        li->head = li->head->prev;
+    
+        if (li->head != 0x0) li->head->nxt = 0x0; else li->tail = 0x0;
+        if (li->finger == tmp) li->finger = 0x0; else li->finger_index--;
+        nodereleasecmp_1(li, tmp);
+        li->length--;
+        li->indexed = 0;
+
+        return;
+    }
+}
+
+/*
+ * Description:
+ *    - Removes a node from the list and returns a copy of its array. Must free manually afterward.
+ *    - The pop of a work queue: on a thread-safe or lock-free list, every node goes to exactly one caller.
+ *
+ * Parameters:
+ *    - list_ptr => pointer to the list
+ *    - location => FRONT: pop from the head | BACK: pop from the tail
+ *    - size => receives the array size (0 when nothing was taken)
+ *
+ * Return: copy of the array | 0x0 (empty, invalid, or out of memory: nothing is removed then)
+ * Time Complexity: O(array_size)
+ */
+int *list_take(list_ptr *li, int location, int *size) {
+    if (size) *size = 0;
+    if (!li || !size || (location != FRONT && location != BACK)) return 0x0;
+
+    int *copy = 0x0;
+    if (li->threadsafe || li->lockfree) {
+        int phase = safeentercmp_1(li);
+        if (li->lockfree) linkreleasecmp_1(li, lockfreepopcmp_1(li, location, &copy, size));
+        else safepopcmp_1(li, location, &copy, size);
+        safeleavecmp_1(li, phase);
+        return copy;
+    }
+
+    list_t *current = (location == FRONT) ? li->head : li->tail;
+    if (!current) return 0x0;
+
+    int capacity = 0;
+    if (!takebuffercmp_1(&copy, &capacity, current->size)) return 0x0;
+    memcpy(copy, current->array, current->size * sizeof(int));
+    *size = current->size;
+    list_pop(li, location);
+    return copy;
+}
+
+/*
+ * Description:
+ *    - Adds count nodes at once, as if list_push were called for each array in turn.
+ *    - Nodes and their arrays are carved from a few large blocks and linked in one pass.
+ *
+ * Parameters:
+ *    - list_ptr => pointer to the list
+ *    - location => FRONT: push to the head | BACK: push to the tail
+ *    - data => the arrays, back to back
+ *    - sizes => size of each array
+ *    - count => number of arrays
+ *
+ * Time Complexity: O(count + total_size)
+ */
+void list_push_bulk(list_ptr *li, int location, const int *data, const int *sizes, int count) {
+    if (!li || !data || !sizes || count <= 0 || (location != FRONT && location != BACK)) return;
+    for (int i = 0; i < count; i++) if (sizes[i] <= 0) return;
+
+    bulkpushcmp_1(li, location, (int *) data, sizes, count, FALSE, FALSE);
+}
+
+/*
+ * Description:
+ *    - Adds count nodes at once without copying: each node's array points into data.
+ *    - Writes within a node's size go straight to data. A node that grows moves to its own array.
+ *
+ * Parameters:
+ *    - list_ptr => pointer to the list
+ *    - location => FRONT: push to the head | BACK: push to the tail
+ *    - data => the arrays, back to back
+ *    - sizes => size of each array
+ *    - count => number of arrays
+ *    - free_data => FALSE: data must outlive the nodes | TRUE: data (from malloc) is freed with the last of them
+ *
+ * Time Complexity: O(count)
+ */
+void list_adopt_bulk(list_ptr *li, int location, int *data, const int *sizes, int count, int free_data) {
+    if (!li || !data || !sizes || count <= 0 || (location != FRONT && location != BACK)) return;
+    for (int i = 0; i < count; i++) if (sizes[i] <= 0) return;
+
+    bulkpushcmp_1(li, location, data, sizes, count, TRUE, free_data);
+}
+
+/*
+ * Removes every node, keeping them in the list's pool for later pushes.
+ * Parameters:
+ *    - list_ptr => pointer to the list
+ * 
+ * Time Complexity: O(node)
+ */
+void list_clear(list_ptr *li) {
+    if (!li) return;
+    list_t *current = li->tail;
+    list_t *tmp;
+
+    while (current != 0x0) {
+        tmp = current;
+        current = current->nxt;
+        nodereleasecmp_1(li, tmp);
+    }
+
+    li->tail = 0x0;
+    li->head = 0x0;
+    li->length = 0;
+    li->indexed = 0;
+    li->finger = 0x0;
+}
+
+void list_lockfree(list_ptr *li, int enable);
+
+/*
+ * Frees the whole list, including nodes held by its pool.
+ * Parameters:
+ *    - list_ptr => pointer to the list
+ * 
+ * Time Complexity: O(node + pooled node)
+ */
+void list_free(list_ptr *li) {
+    if (!li) return;
+    list_lockfree(li, FALSE);
+    list_clear(li);
+    nodereclaimcmp_1(li);
+    pooldraincmp_1(li);
+
+    free(li->directory);
+    free(li->cumulative);
+    li->directory = 0x0;
+    li->cumulative = 0x0;
+    li->directory_capacity = 0;
+
+    free(li->stripes);
+    li->stripes = 0x0;
+    li->threadsafe = FALSE;
+}
+
+/*
+ * Description:
+ *    - Writes the list to a file: a directory of node sizes and offsets, then every array back to back.
+ *    - Hints and summaries are kept, so a loaded node needs no rescan. The file uses the machine's byte order.
+ *
+ * Parameters:
+ *    - list_ptr => pointer to the list
+ *    - path => file to create or overwrite
+ *
+ * Return: TRUE | FALSE (Invalid or I/O error)
+ * Time Complexity: O(node + total_size)
+ */
+int list_save(list_ptr *li, const char *path) {
+    if (!li || !path || li->threadsafe) return FALSE;
+
+    FILE *file = fopen(path, "wb");
+    if (!file) return FALSE;
+
+    list_file header = {LIST_FILE_MAGIC, li->length, 0, 0};
+    header.payload = (sizeof(list_file) + li->length * sizeof(list_file_node) + LIST_FILE_ALIGN - 1) & ~(long long) (LIST_FILE_ALIGN - 1);
+    for (list_t *current = li->head; current != 0x0; current = current->prev) header.total += current->size;
+
+    int ok = (fwrite(&header, sizeof(list_file), 1, file) == 1);
+    long long offset = 0;
+    for (list_t *current = li->head; ok && current != 0x0; current = current->prev) {
+        list_file_node entry = {offset, current->size, current->flags & (LIST_READ_MOSTLY | LIST_HASHED | LIST_SORTED | LIST_SUMMARY), current->min, current->max};
+        ok = (fwrite(&entry, sizeof(list_file_node), 1, file) == 1);
+        offset += current->size;
+    }
+
+    long long padding = header.payload - (long long) (sizeof(list_file) + li->length * sizeof(list_file_node));
+    for (; ok && padding > 0; padding--) ok = (fputc(0, file) != EOF);
+
+    for (list_t *current = li->head; ok && current != 0x0; current = current->prev) {
+        ok = ((int) fwrite(current->array, sizeof(int), current->size, file) == current->size);
+    }
+
+    if (fclose(file) != 0) ok = FALSE;
+    return ok;
+}
+
+/*
+ * Description:
+ *    - Loads a file written by list_save without copying its arrays: the file is mapped and every node points into it.
+ *    - Writes within a node's size stay private to the process, the file is never modified. A node that grows moves to its own array.
+ *    - The mapping is released with the last node that points into it.
+ *
+ * Parameters:
+ *    - path => file written by list_save
+ *
+ * Return: pointer to the list_ptr | 0x0 (Invalid or I/O error)
+ * Time Complexity: O(node)
+ */
+list_ptr *list_load_mapped(const char *path) {
+    if (!path) return 0x0;
+
+    FILE *file = fopen(path, "rb");
+    if (!file) return 0x0;
+
+    struct stat info;
+    if (fstat(fileno(file), &info) != 0 || info.st_size < (off_t) sizeof(list_file)) {
+        fclose(file);
+        return 0x0;
+    }
+
+    size_t bytes = (size_t) info.st_size;
+    void *base = mmap(0x0, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileno(file), 0);
+    fclose(file);
+    if (base == MAP_FAILED) return 0x0;
+
+    // every count comes from the file: checked against its size before use, without products that could overflow
+    list_file *header = (list_file *) base;
+    list_file_node *entries = (list_file_node *) (header + 1);
+    int valid = (header->magic == LIST_FILE_MAGIC && header->count >= 0
+        && header->payload >= 0 && (unsigned long long) header->payload <= bytes
+        && sizeof(list_file) + (size_t) header->count * sizeof(list_file_node) <= (unsigned long long) header->payload
+        && header->payload % sizeof(int) == 0 && header->total >= 0
+        && (unsigned long long) header->total <= (bytes - (size_t) header->payload) / sizeof(int));
+
+    for (int i = 0; valid && i < header->count; i++) {
+        valid = (entries[i].size >= 0 && entries[i].offset >= 0 && entries[i].offset <= header->total - entries[i].size);
+    }
+
+    list_ptr *li = (valid) ? list_init() : 0x0;
+    int *sizes = (li && header->count) ? (int *) malloc(header->count * sizeof(int)) : 0x0;
+    if (!li || (header->count && !sizes)) {
+        free(li);
+        munmap(base, bytes);
+        return 0x0;
+    }
+
+    if (!header->count) {
+        munmap(base, bytes);
+        return li;
+    }
+
+    int *data = (int *) ((unsigned char *) base + header->payload);
+    for (int i = 0; i < header->count; i++) sizes[i] = entries[i].size;
+    bulkpushcmp_1(li, BACK, data, sizes, header->count, TRUE, FALSE);
+    free(sizes);
+
+    if (li->length != header->count) { // out of memory part way: the mapping is not owned by any block yet
+        list_free(li);
+        free(li);
+        munmap(base, bytes);
+        return 0x0;
+    }
+
+    li->head->slab->data = (int *) base;
+    li->head->slab->mapped = bytes;
+
+    int i = 0;
+    for (list_t *current = li->head; current != 0x0; current = current->prev, i++) {
+        current->array = data + entries[i].offset;
+        current->flags |= entries[i].flags & (LIST_READ_MOSTLY | LIST_HASHED | LIST_SORTED | LIST_SUMMARY);
+        current->min = entries[i].min;
+        current->max = entries[i].max;
+    }
+
+    return li;
+}
+
+/*
+ * Description:
+ *    - Switches thread-safe mode, for several threads pushing, popping and using iterators on one list.
+ *    - Writers (write, erase, sort, hint) lock only their node, so writers on different nodes run in parallel.
+ *    - Readers (size, find, find_batch, retrieve) never lock: they read a seqlock snapshot and retry if a writer got in between.
+ *    - Structural changes (push, pop, insert, delete) lock only the neighbouring nodes, and the list itself at head or tail.
+ *    - Unlinked nodes and replaced arrays are retired: every covered call counts itself in while it runs, and once
+ *      LIST_RETIRE_BATCH are retired, the next call to return waits for the calls already running to finish, then frees them.
+ *      If the memory to track a retirement cannot be allocated, pop and delete leave the list as it was and a grow fails.
+ *    - Other list_ calls are not covered. A node must not be deleted while another thread still points an iterator at it.
+ *    - Stays off while the list is lock-free (see list_lockfree), or if the per-thread counters cannot be allocated.
+ *
+ * Parameters:
+ *    - list_ptr => pointer to the list
+ *    - enable => TRUE | FALSE (no other thread may use the list while switching)
+ *
+ * Time Complexity: O(1) on | O(retired) off
+ */
+void list_threadsafe(list_ptr *li, int enable) {
+    if (!li || li->lockfree || (enable && !stripeallocatecmp_1(li))) return;
+
+    li->threadsafe = (enable) ? TRUE : FALSE;
+    li->indexed = 0;
+    li->finger = 0x0;
+    if (!enable) nodereclaimcmp_1(li);
+}
+
+/*
+ * Description:
+ *    - Switches lock-free mode, for a list used as a deque by many threads: list_push, list_pop and list_take
+ *      (and list_push_bulk, list_adopt_bulk) at both ends, with no lock anywhere.
+ *    - Each end is claimed with a compare-and-swap on the node next to its own anchor, so the head and the tail
+ *      do not contend with each other, and a thread stalled anywhere never keeps the others from finishing.
+ *    - Nodes count the links pointing to them: a popped node is dropped once none is left, then freed
+ *      like a retired node of a thread-safe list, after every call that was running has returned (see list_threadsafe).
+ *    - Other list_ calls see an empty list until the mode is switched off, then find every node still pushed.
+ *      Iterators created before must not be used in between. The mode excludes thread-safe mode.
+ *
+ * Parameters:
+ *    - list_ptr => pointer to the list
+ *    - enable => TRUE | FALSE (no other thread may use the list while switching)
+ *
+ * Time Complexity: O(node)
+ */
+void list_lockfree(list_ptr *li, int enable) {
+    if (!li || li->threadsafe || (enable != FALSE) == (li->lockfree != FALSE)) return;
+
+    if (enable) {
+        if (!stripeallocatecmp_1(li)) return;
+        list_t *head = (list_t *) calloc(1, sizeof(list_t));
+        list_t *tail = (list_t *) calloc(1, sizeof(list_t));
+        if (!head || !tail) {
+            free(head);
+            free(tail);
+            return;
+        }
+        head->flags = tail->flags = LIST_ANCHOR;
+
+        head->prev = (li->head) ? li->head : tail;
+        tail->nxt = (li->tail) ? li->tail : head;
+        if (li->head) {
+            li->head->nxt = head;
+            li->tail->prev = tail;
+        }
+        for (list_t *current = li->head; current != 0x0 && current != tail; current = current->prev) current->links = 2; // both neighbours
+
+        li->anchor[0] = head;
+        li->anchor[1] = tail;
+        li->head = li->tail = 0x0;
+        li->length = 0;
+        li->indexed = 0;
+        li->finger = 0x0;
+        li->finger_index = 0;
+        li->lockfree = TRUE;
+        return;
+    }
+
+    list_t *head = li->anchor[0], *tail = li->anchor[1];
+    int length = 0;
+    for (list_t *prev = head, *current = head->prev; prev != tail; prev = current, current = current->prev) { // deleted nodes only kept by stale hints go now
+        if (linknodecmp_1(current->nxt) != prev) {
+            linkholdcmp_1(prev);
+            linkstorecmp_1(li, &current->nxt, prev);
+        }
+        if (current != tail) length++;
+    }
+    nodereclaimcmp_1(li);
+
+    li->head = (length) ? head->prev : 0x0;
+    li->tail = (length) ? tail->nxt : 0x0;
+    if (length) {
+        li->head->nxt = 0x0;
+        li->tail->prev = 0x0;
+    }
+    free(head);
+    free(tail);
+
+    li->anchor[0] = li->anchor[1] = 0x0;
+    li->length = length;
+    li->lockfree = FALSE;
+}
+
+/*
+ * Description:
+ *    - Moves every node into one block, laid out from head to tail, and rewrites the links.
+ *    - Walking the list afterward reads memory in order, as an array would, instead of jumping around the heap.
+ *    - The pool is emptied too, so blocks that only pooled nodes kept alive are given back.
+ *    - Iterators into the list point to the old nodes and must be created again. Not available in thread-safe mode.
+ *    - Borrowed spans are invalidated: the old nodes are freed, so list_span_valid cannot check them, drop every span first.
+ *
+ * Parameters:
+ *    - list_ptr => pointer to the list
+ *    - payload => FALSE: only arrays stored inside a node (or adopted) move with it | TRUE: every array moves next to its node
+ *
+ * Time Complexity: O(node + total_size)
+ */
+void list_compact(list_ptr *li, int payload) {
+    if (!li || li->threadsafe || !li->head) return;
+
+    size_t header = (sizeof(list_slab) + 15) & ~(size_t) 15;
+    size_t bytes = header;
+    for (list_t *current = li->head; current != 0x0; current = current->prev) {
+        int inline_size = (payload || !nodeownscmp_1(current)) ? current->size : 0;
+        bytes += (sizeof(list_t) + inline_size * sizeof(int) + 7) & ~(size_t) 7;
+    }
+
+    list_slab *slab = (list_slab *) malloc(bytes);
+    if (!slab) return;
+    slab->refs = li->length;
+    slab->data = 0x0;
+    slab->mapped = 0;
+
+    unsigned char *cursor = (unsigned char *) slab + header;
+    list_t *last = 0x0;
+    list_t *current = li->head;
+
+    while (current != 0x0) {
+        list_t *tmp = current;
+        current = current->prev;
+
+        int moved = (payload || !nodeownscmp_1(tmp)); // array is copied in, otherwise its heap block is handed over
+        list_t *a = (list_t *) cursor;
+        cursor += (sizeof(list_t) + ((moved) ? tmp->size : 0) * sizeof(int) + 7) & ~(size_t) 7;
+
+        a->slab = slab;
+        a->size = tmp->size;
+        a->layout = tmp->layout;
+        a->index = tmp->index;
+        a->min = tmp->min;
+        a->max = tmp->max;
+        a->lock = 0;
+        a->seq = 0;
+        a->generation = 0;
+
+        if (moved) {
+            memcpy(a->payload, tmp->array, tmp->size * sizeof(int));
+            a->array = a->payload;
+            a->capacity = tmp->size;
+            a->inline_capacity = tmp->size;
+            a->flags = tmp->flags & ~LIST_ADOPTED;
+        } else {
+            a->array = tmp->array;
+            a->capacity = tmp->capacity;
+            a->inline_capacity = 0;
+            a->flags = tmp->flags;
+            tmp->array = tmp->payload;
+        }
+        a->pool = nodeclasscmp_1(a->inline_capacity);
+        tmp->layout = 0x0;
+        tmp->index = 0x0;
+
+        a->nxt = last;
+        a->prev = 0x0;
+        if (last) last->prev = a; else li->head = a;
+        last = a;
+
+        nodefreecmp_1(tmp);
+    }
+
+    li->tail = last;
+    li->indexed = 0;
+    li->finger = 0x0;
+    pooldraincmp_1(li);
+}
+
+/*
+ * Description:
+ *    - Writes the input array to a specific range in a specific list.
+ *    - To access the last element, set start and end to -1.
+ *    - Automatically resizes the array if end_location exceeds its current size, with extra memory reserved (optional).
+ *    - Capacity at least doubles on each resize, so writing one element past the end at a time is amortized O(1).
+ *
+ * Parameters:
+ *    - list_ptr => pointer to the list
+ *    - index => 0: forward | -1: backward
+ *    - start, end => write range
+ *    - input => pointer to the input array
+ *    - reserved => number of extra elements to pre-allocate on resize
+ *
+ * Time Complexity: O(index + input_size)
+ */
+void list_write(list_ptr *li, int index, int start, int end, int *input, int reserved) {
+    if (!li || !input || start > end) return;
+
+    list_t *current = nodelocatecmp_1(li, index);
+    if (!current) return;
+
+    if (writecmp_1(current, start, end, input, reserved)) li->indexed = 0;
+}
+
+/*
+ * Returns size of an array in a specified list. 
+ * Recommended to use in list_write start, end argument to write to the back
+ * Eg. list_write(pointer, 0, list_size(pointer, 0) - 1, list_size(pointer, 0) + 9, input, 0);
+ * Parameters:
+ *    - list_ptr => pointer to the list
+ *    - index => 0: forward | -1: backward
+ * 
+ * Time Complexity: O(index)
+ */
+int list_size(list_ptr *li, int index) {
+    if (!li) return -1;
+
+    list_t *current = nodelocatecmp_1(li, index);
+    if (!current) return -1;
+
+    return current->size;
+}
+
+/*
  * Description:
  *    - Deletes element in a specific range, list. 
  *    - To access the last element, set start and end to -1.
  *    - Deleting from the end is recommended as it avoids shifting elements. 
- *    - Deleting from the start requires moving other elements to fill the gap.
+ *    - Deleting from the start moves the following elements down with one memmove to fill the gap.
  *
  * Parameters:
  *    - list_ptr => pointer to the list
  *    - index => 0: forward | -1: backward
  *    - start, end => erase range
- *    - free_memory => FALSE | TRUE
+ *    - free_memory => FALSE | TRUE (the array is only reallocated once it is at most a quarter full)
  *
  * Time Complexity: 
  *    - O(index + array_size) in the worst case
@@ -343,40 +3107,48 @@ int list_size(list_ptr *li, int index) {
 void list_erase(list_ptr *li, int index, int start, int end, int free_memory) {
     if (!li || start > end) return;
 
-    list_t *current = (index >= 0) ? li->head : li->tail;
-    int count = (index >= 0) ? 0 : -1;
+    list_t *current = nodelocatecmp_1(li, index);
+    if (!current) return;
 
-    while (current != 0x0) {
-        if (count == index) {
-            if (start == -1 && end == -1) {
-                current->array[current->size - 1] = 0xFFFFFFFF;
-
-                if (free_memory) {
-                    int *new_array = (int*) realloc(current->array, current->size - 1 * sizeof(int));
-                    current->array = new_array;
-                    current->size--;
-                }
-                return;
-            }
+    if (erasecmp_1(current, start, end, free_memory, FALSE)) li->indexed = 0;
+}
 
-            if (start < 0) return;
+/*
+ * Description:
+ *    - Grows a specific list's array to hold at least capacity elements, without changing its size.
+ *    - Writes up to that capacity then never reallocate.
+ *
+ * Parameters:
+ *    - list_ptr => pointer to the list
+ *    - index => 0: forward | -1: backward
+ *    - capacity => number of elements to make room for
+ *
+ * Time Complexity: O(index + array_size)
+ */
+void list_reserve(list_ptr *li, int index, int capacity) {
+    if (!li || capacity <= 0) return;
+    list_t *current = nodelocatecmp_1(li, index);
+    if (!current) return;
 
-            for (int i = end + 1; i < current->size; i++) {
-                current->array[i - (end - start + 1)] = current->array[i];
-                current->array[i] = 0xFFFFFFFF;
-            }
+    nodegrowcmp_1(current, capacity);
+}
 
-            if (free_memory) {
-                int *new_array = (int*) realloc(current->array, (current->size - (end - start + 1)) * sizeof(int));
-                current->array = new_array;
-                current->size -= (end - start + 1);
-            }
-            return;
-        }
+/*
+ * Description:
+ *    - Releases the unused capacity of a specific list's array, moving it back inside the node when it fits.
+ *
+ * Parameters:
+ *    - list_ptr => pointer to the list
+ *    - index => 0: forward | -1: backward
+ *
+ * Time Complexity: O(index + array_size)
+ */
+void list_shrink(list_ptr *li, int index) {
+    if (!li) return;
+    list_t *current = nodelocatecmp_1(li, index);
+    if (!current) return;
 
-        current = (index >= 0) ? current->nxt : current->prev;
-        count += (index >= 0) ? 1 : -1;
-    }
+    nodefitcmp_1(current, current->size);
 }
 
 /*
@@ -384,34 +3156,20 @@ void list_erase(list_ptr *li, int index, int start, int end, int free_memory) {
  * Parameters:
  *    - list_ptr => pointer to the list
  *    - index => 0: forward | -1: backward
- *    - option => 0: bubble | 1: merge (recommended)
+ *    - option => 0: bubble | 1: merge | 2: radix (recommended) | 3: introsort (in place)
  *
  * Time Complexity:
- *    - bubble: O(array_size) best case | O(n^array_size) worst case
- *    - merge: O(array_size log array_size) all cases
+ *    - bubble: O(array_size) best case | O(array_size^2) worst case
+ *    - merge: O(array_size log array_size) all cases, one array_size scratch buffer
+ *    - radix: O(array_size) all cases, one array_size scratch buffer
+ *    - introsort: O(array_size log array_size) all cases, no scratch buffer
  */
 void list_sort(list_ptr *li, int index, int option) {
     if (!li) return;
-    list_t *current = (index >= 0) ? li->head : li->tail;
-    int count = (index >= 0) ? 0 : -1;
-
-    while (current != 0x0) {
-        if (count == index) {
-            switch (option) {
-                case 0:
-                    bubblesortcmp_1(current);
-                    return;
-                case 1:
-                    mergesortcmp_2(current->array, 0, current->size - 1);
-                    return;
-                default:
-                    return;
-            }
-        }
+    list_t *current = nodelocatecmp_1(li, index);
+    if (!current) return;
 
-        current = (index >= 0) ? current->nxt : current->prev;
-        count += (index >= 0) ? 1 : -1;
-    }
+    sortcmp_1(current, option);
 }
 
 /*
@@ -422,79 +3180,645 @@ void list_sort(list_ptr *li, int index, int option) {
  *    - start, end => search range (linear search supports backward searching)
  *    - target => pointer to group of target number
  *    - target_size => group of target number's size
- *    - option => 0: linear search | 1: binary search (sorted array)
+ *    - option => 0: linear search | 1: binary search (sorted array) | 2: hash lookup (LIST_HASHED, linear otherwise)
  *    - returnType => 0: index | 1: boolean
  * 
  * Return: (index | 0xFFFFFFFF) | (TRUE | FALSE) | -1 (Invalid)
  * Time Complexity:
  *    - linear search: O(index) best case | O(index + search_range * target_size) worst case
+ *      (compares 8 elements per instruction with avx2, 4 with sse2, selected at runtime)
  *    - binary search: O(index + log search_range * target_size) all cases
+ *      (branchless; nodes hinted LIST_READ_MOSTLY search a cached eytzinger layout instead)
+ *    - hash lookup: O(index + target_size) expected, plus O(array_size) to build the hash once
+ *      (the thread-safe mode searches linearly instead)
+ *    - with a summary (list_sort, list_summary): linear searches forward on a sorted array run as binary searches,
+ *      and O(index + target_size) when every target lies outside [min, max]
  */
 int list_find(list_ptr *li, int index, int start, int end, int *target, int target_size, int option, int returnType) {
+    if (!li || option < 0 || option > 2) return -1;
+    list_t *current = nodelocatecmp_1(li, index);
+    if (!current) return -1;
+
+    int result = findcmp_1(current, start, end, target, target_size, option);
+    return (returnType) ? (result == 0xFFFFFFFF) ? FALSE : TRUE : result;
+}
+
+/*
+ * Description:
+ *    - Reads the summary of a specific list: its smallest and largest element, and whether it is sorted.
+ *    - Computed in one pass on first use and kept until the array changes. list_sort sets it at no cost.
+ *    - With a summary, linear searches on a sorted array run as binary searches,
+ *      and searches return at once when every target lies outside [min, max].
+ *
+ * Parameters:
+ *    - list_ptr => pointer to the list
+ *    - index => 0: forward | -1: backward
+ *    - min, max => receive the smallest and largest element (optional: 0x0)
+ *
+ * Return: TRUE (sorted) | FALSE (unsorted) | -1 (Invalid)
+ * Time Complexity: O(index + array_size) first call | O(index) afterward
+ */
+int list_summary(list_ptr *li, int index, int *min, int *max) {
+    if (!li) return -1;
+    list_t *current = nodelocatecmp_1(li, index);
+    if (!current) return -1;
+
+    nodesummarycmp_1(current);
+    if (min) *min = current->min;
+    if (max) *max = current->max;
+    return (current->flags & LIST_SORTED) ? TRUE : FALSE;
+}
+
+/*
+ * Description:
+ *    - Sets access hints on a specific list.
+ *    - LIST_READ_MOSTLY: binary searches build and keep an eytzinger copy of the (sorted) array,
+ *      trading one extra array_size of memory for fewer cache misses per search. Any write drops the copy.
+ *    - LIST_HASHED: hash lookups (find option 2) keep a hash from value to positions, built on first use.
+ *      Writes and erases at the end update it in place, larger changes rebuild it. Costs 4 to 8 array_size of memory.
+ *
+ * Parameters:
+ *    - list_ptr => pointer to the list
+ *    - index => 0: forward | -1: backward
+ *    - hint => 0 | LIST_READ_MOSTLY | LIST_HASHED (combinable)
+ *
+ * Time Complexity: O(index)
+ */
+void list_hint(list_ptr *li, int index, int hint) {
     if (!li) return;
-    list_t *current = (index >= 0) ? li->head : li->tail;
-    int count = (index >= 0) ? 0 : -1;
+    list_t *current = nodelocatecmp_1(li, index);
+    if (!current) return;
 
-    while (current != 0x0) {
-        if (count == index) {
-            switch (option) {
-                case 0:
-                    int result = linearsearchcmp_1(current, start, end, target, target_size);
-                    return (returnType) ? (result == 0xFFFFFFFF) ? FALSE : TRUE : result;
-                case 1:
-                    int result = binarysearchcmp_1(current, start, end, target, target_size);
-                    return (returnType) ? (result == 0xFFFFFFFF) ? FALSE : TRUE : result;
-                default:
-                    return -1;
+    if (!(hint & LIST_READ_MOSTLY)) nodelayoutdropcmp_1(current); // the data did not change: spans, summary and sortedness stay
+    if (!(hint & LIST_HASHED)) indexdropcmp_1(current);
+    current->flags = (current->flags & ~(LIST_READ_MOSTLY | LIST_HASHED)) | (hint & (LIST_READ_MOSTLY | LIST_HASHED));
+}
+
+/*
+ * Description:
+ *    - Binary searches many targets in a specific list (sorted array) in one call.
+ *    - Searches advance in lockstep, so their memory accesses overlap instead of queueing.
+ *
+ * Parameters:
+ *    - list_ptr => pointer to the list
+ *    - index => 0: forward | -1: backward
+ *    - start, end => search range
+ *    - target => pointer to the targets
+ *    - target_size => number of targets
+ *    - result => receives, per target, its first index or 0xFFFFFFFF
+ *
+ * Return: number of targets found | -1 (Invalid)
+ * Time Complexity: O(index + target_size * log search_range)
+ */
+int list_find_batch(list_ptr *li, int index, int start, int end, int *target, int target_size, int *result) {
+    if (!li || !target || !result || target_size < 0) return -1;
+    list_t *current = nodelocatecmp_1(li, index);
+    if (!current) return -1;
+
+    if (start < 0 || start > end || end >= current->size) return -1;
+    binarysearchcmp_4(current, start, end, target, target_size, result);
+
+    int found = 0;
+    for (int i = 0; i < target_size; i++) found += (result[i] != 0xFFFFFFFF);
+    return found;
+}
+
+
+/*
+ * Description:
+ *    - Sums a range of a specific list and finds its smallest and largest element and how many elements equal value, in one pass.
+ *    - Runs 8 elements at a time where the CPU supports AVX2. Ranges of at least 2 * LIST_REDUCE_GRAIN are split across threads.
+ *
+ * Parameters:
+ *    - list_ptr => pointer to the list
+ *    - index => 0: forward | -1: backward
+ *    - start, end => reduce range
+ *    - value => element to count
+ *    - threads => threads to use at most, counting the caller (0, 1: caller only)
+ *    - result => receives the sum, min, max, their first index, and the count
+ *
+ * Return: TRUE | FALSE (Invalid)
+ * Time Complexity: O(index + reduce_range / threads)
+ */
+int list_reduce(list_ptr *li, int index, int start, int end, int value, int threads, list_reduction *result) {
+    if (!li || !result) return FALSE;
+    list_t *current = nodelocatecmp_1(li, index);
+    if (!current || start < 0 || start > end || end >= current->size) return FALSE;
+
+    reducecmp_3(current->array, start, end, value, threads, result);
+    return TRUE;
+}
+
+/*
+ * Description:
+ *    - Counts the elements of a range of a specific list into buckets of equal width.
+ *    - Bucket b holds low + b * width up to, not including, low + (b + 1) * width. Elements outside every bucket are skipped.
+ *
+ * Parameters:
+ *    - list_ptr => pointer to the list
+ *    - index => 0: forward | -1: backward
+ *    - start, end => histogram range
+ *    - low => smallest element of the first bucket
+ *    - width => elements per bucket
+ *    - buckets => number of buckets
+ *    - counts => receives buckets counts (cleared first)
+ *
+ * Return: number of elements counted | -1 (Invalid)
+ * Time Complexity: O(index + histogram_range + buckets)
+ */
+int list_histogram(list_ptr *li, int index, int start, int end, int low, int width, int buckets, int *counts) {
+    if (!li || !counts || width <= 0 || buckets <= 0) return -1;
+    list_t *current = nodelocatecmp_1(li, index);
+    if (!current || start < 0 || start > end || end >= current->size) return -1;
+
+    return histogramcmp_1(current->array, start, end, low, width, buckets, counts);
+}
+
+/*
+ * Retrieves the array from a specific list. Must free manually afterward.
+ * To access the last element, set start and end to -1.
+ * Parameters:
+ *    - list_ptr => pointer to the list
+ *    - index => 0: forward | -1: backward
+ *    - start, end => retrieve range
+ *
+ * Return: copy of pointer to the array
+ * Time Complexity: O(index + retrieve_size)
+ */
+int *list_retrieve(list_ptr *li, int index, int start, int end) {
+    if (!li || start > end) return 0x0;
+
+    list_t *current = nodelocatecmp_1(li, index);
+    if (!current) return 0x0;
+
+    list_span span = spancmp_1(current, start, end);
+    if (!span.ptr) return 0x0;
+
+    int *copy = (int *) malloc(span.len * sizeof(int));
+    if (!copy) return 0x0;
+    memcpy(copy, span.ptr, span.len * sizeof(int));
+    return copy;
+}
+
+/*
+ * Description:
+ *    - Borrows a range of a specific list without copying it, as list_retrieve would return.
+ *    - The span points into the node and stays valid until the node is next written, resized, popped or freed.
+ *    - To access the last element, set start and end to -1.
+ *
+ * Parameters:
+ *    - list_ptr => pointer to the list
+ *    - index => 0: forward | -1: backward
+ *    - start, end => borrow range
+ *
+ * Return: span over the range | span with ptr 0x0 (Invalid)
+ * Time Complexity: O(index)
+ */
+list_span list_borrow(list_ptr *li, int index, int start, int end) {
+    list_span span = {0x0, 0, 0x0, 0};
+    if (!li) return span;
+    return spancmp_1(nodelocatecmp_1(li, index), start, end);
+}
+
+/*
+ * Description:
+ *    - Tells whether a span still describes its node, i.e. the node was not written or resized since it was borrowed.
+ *    - A node that was popped or freed cannot be checked, its spans must be dropped first.
+ *
+ * Parameters:
+ *    - list_span => the span
+ *
+ * Return: TRUE | FALSE
+ * Time Complexity: O(1)
+ */
+int list_span_valid(list_span span) {
+    return span.ptr && span.node->generation == span.generation;
+}
+
+/*
+ * Description:
+ *    - Reads one element of a span.
+ *    - Built with LIST_DEBUG, aborts when the span went stale or i is out of range, so use after mutation is caught where it happens.
+ *
+ * Parameters:
+ *    - list_span => the span
+ *    - i => element index inside the span
+ *
+ * Return: element
+ * Time Complexity: O(1)
+ */
+int list_span_at(list_span span, int i) {
+#ifdef LIST_DEBUG
+    if (!list_span_valid(span) || i < 0 || i >= span.len) abort();
+#endif
+    return span.ptr[i];
+}
+
+/*
+ * Description:
+ *    - Switches the list to unrolled mode, where every node holds a slice of one logical sequence.
+ *    - list_insert splits a node once it exceeds capacity, list_remove merges nodes below a quarter of it.
+ *    - Nodes already in the list are kept as they are, and are split on their next insert.
+ *
+ * Parameters:
+ *    - list_ptr => pointer to the list
+ *    - capacity => elements per node (0: LIST_UNROLLED_CAPACITY | -1: leave unrolled mode)
+ *
+ * Time Complexity: O(1)
+ */
+void list_unrolled(list_ptr *li, int capacity) {
+    if (!li) return;
+
+    if (capacity < 0) capacity = 0;
+    else if (capacity == 0) capacity = LIST_UNROLLED_CAPACITY;
+    else if (capacity < 8) capacity = 8;
+
+    li->unrolled = capacity;
+}
+
+/*
+ * Returns the number of elements over all nodes.
+ * Parameters:
+ *    - list_ptr => pointer to the list
+ *
+ * Time Complexity: O(1) | O(node) after pushing, popping or resizing nodes
+ */
+int list_count(list_ptr *li) {
+    if (!li || !unrolledindexcmp_1(li)) return 0;
+    return li->cumulative[li->length];
+}
+
+/*
+ * Description:
+ *    - Inserts the input array before the element at a global position, counting from the head's first element.
+ *    - To append after the last element, set position to -1.
+ *    - In unrolled mode, an overflowing node is split into nodes filled to 3/4 of the capacity.
+ *
+ * Parameters:
+ *    - list_ptr => pointer to the list
+ *    - position => global element position
+ *    - size => input size
+ *    - input => pointer to the input array
+ *
+ * Time Complexity: O(log node + node capacity + input_size) | O(node) after pushing, popping or resizing nodes
+ */
+void list_insert(list_ptr *li, int position, int size, int *input) {
+    if (!li || size <= 0 || !input || !unrolledindexcmp_1(li)) return;
+
+    int total = li->cumulative[li->length];
+    if (position == -1) position = total;
+    if (position < 0 || position > total) return;
+
+    int fill = (li->unrolled) ? li->unrolled - li->unrolled / 4 : size;
+
+    if (li->length == 0) {
+        for (int i = 0; i < size; i += fill) list_push(li, BACK, (size - i < fill) ? size - i : fill, input + i);
+        return;
+    }
+
+    int k = unrolledlocatecmp_1(li, position);
+    list_t *current = li->directory[k];
+    int offset = position - li->cumulative[k];
+    int merged = current->size + size;
+
+    if (!li->unrolled || merged <= li->unrolled) {
+        if (!nodegrowcmp_1(current, merged)) return;
+        nodetouchcmp_1(current);
+
+        memmove(current->array + offset + size, current->array + offset, (current->size - offset) * sizeof(int));
+        memcpy(current->array + offset, input, size * sizeof(int));
+        current->size = merged;
+        unrolledshiftcmp_1(li, k, k, size);
+        return;
+    }
+
+    int chunks = (merged + fill - 1) / fill;
+    int *buffer = (int *) malloc(merged * sizeof(int));
+    list_t **added = (list_t **) malloc((chunks - 1) * sizeof(list_t *));
+    int ready = buffer && added && unrolledreservecmp_1(li, chunks - 1) && nodegrowcmp_1(current, merged / chunks + (merged % chunks > 0));
+
+    // every node and array is in hand before current changes, so running out of memory leaves the list as it was
+    int acquired = 0;
+    for (; ready && acquired < chunks - 1; acquired++) {
+        int c = acquired + 1;
+        list_t *a = nodeacquirecmp_1(li, li->unrolled);
+        if (a) {
+            a->size = 0;
+            if (!nodegrowcmp_1(a, merged / chunks + (c < merged % chunks))) {
+                nodereleasecmp_1(li, a);
+                a = 0x0;
             }
         }
+        if (!a) {
+            ready = 0;
+            break;
+        }
+        added[acquired] = a;
+    }
 
-        current = (index >= 0) ? current->nxt : current->prev;
-        count += (index >= 0) ? 1 : -1;
+    if (!ready) {
+        while (acquired > 0) nodereleasecmp_1(li, added[--acquired]);
+        free(buffer);
+        free(added);
+        return;
+    }
+
+    nodetouchcmp_1(current);
+    memcpy(buffer, current->array, offset * sizeof(int));
+    memcpy(buffer + offset, input, size * sizeof(int));
+    memcpy(buffer + offset + size, current->array + offset, (current->size - offset) * sizeof(int));
+
+    int taken = 0;
+    for (int c = 0; c < chunks; c++) {
+        int part = merged / chunks + (c < merged % chunks);
+        list_t *a = (c > 0) ? added[c - 1] : current;
+        if (c > 0) unrolledlinkcmp_1(li, k + c - 1, a);
+
+        memcpy(a->array, buffer + taken, part * sizeof(int));
+        if (a == current) nodeshrinkcmp_1(a, part); else a->size = part;
+        taken += part;
+    }
+
+    free(buffer);
+    free(added);
+    unrolledshiftcmp_1(li, k, k + chunks - 1, size);
+}
+
+/*
+ * Description:
+ *    - Deletes elements in a global range, counting from the head's first element.
+ *    - Nodes left empty are removed from the list.
+ *    - In unrolled mode, a node left below a quarter of the capacity is merged with (or rebalanced against) its neighbour.
+ *
+ * Parameters:
+ *    - list_ptr => pointer to the list
+ *    - start, end => global erase range
+ *
+ * Time Complexity: O(log node + node capacity + erase_size) | O(node) after pushing, popping or resizing nodes
+ */
+void list_remove(list_ptr *li, int start, int end) {
+    if (!li || start < 0 || start > end || !unrolledindexcmp_1(li)) return;
+    if (end >= li->cumulative[li->length]) return;
+
+    int k = unrolledlocatecmp_1(li, start);
+    int offset = start - li->cumulative[k];
+    int remaining = end - start + 1;
+    int j = k;
+
+    while (1) {
+        list_t *current = li->directory[j];
+        int taken = current->size - offset;
+        nodetouchcmp_1(current);
+        if (taken > remaining) taken = remaining;
+
+        memmove(current->array + offset, current->array + offset + taken, (current->size - offset - taken) * sizeof(int));
+        current->size -= taken;
+        remaining -= taken;
+        offset = 0;
+
+        if (remaining == 0) break;
+        j++;
+    }
+
+    unrolledshiftcmp_1(li, k, j, -(end - start + 1));
+    for (int i = j; i >= k; i--) if (li->directory[i]->size == 0) unrolledunlinkcmp_1(li, i);
+
+    if (li->unrolled) {
+        unrolledmergecmp_1(li, k + 1);
+        unrolledmergecmp_1(li, k);
+    }
+}
+
+/*
+ * Returns the element at a global position, counting from the head's first element.
+ * To access the last element, set position to -1.
+ * Parameters:
+ *    - list_ptr => pointer to the list
+ *    - position => global element position
+ *
+ * Return: element | 0xFFFFFFFF (Invalid)
+ * Time Complexity: O(log node) | O(node) after pushing, popping or resizing nodes
+ */
+int list_at(list_ptr *li, int position) {
+    if (!li || !unrolledindexcmp_1(li)) return 0xFFFFFFFF;
+
+    int total = li->cumulative[li->length];
+    if (position == -1) position = total - 1;
+    if (position < 0 || position >= total) return 0xFFFFFFFF;
+
+    int k = unrolledlocatecmp_1(li, position);
+    return li->directory[k]->array[position - li->cumulative[k]];
+}
+
+/*
+ * Reads a global range across nodes, counting from the head's first element. Must free manually afterward.
+ * Parameters:
+ *    - list_ptr => pointer to the list
+ *    - start, end => global read range
+ *
+ * Return: copy of pointer to the array
+ * Time Complexity: O(log node + read_size) | O(node) after pushing, popping or resizing nodes
+ */
+int *list_read(list_ptr *li, int start, int end) {
+    if (!li || start < 0 || start > end || !unrolledindexcmp_1(li)) return 0x0;
+    if (end >= li->cumulative[li->length]) return 0x0;
+
+    int *copy = (int *) malloc((end - start + 1) * sizeof(int));
+    if (!copy) return 0x0;
+
+    int k = unrolledlocatecmp_1(li, start);
+    int offset = start - li->cumulative[k];
+    int copied = 0;
+
+    while (copied < end - start + 1) {
+        list_t *current = li->directory[k++];
+        int taken = current->size - offset;
+        if (taken > end - start + 1 - copied) taken = end - start + 1 - copied;
+
+        memcpy(copy + copied, current->array + offset, taken * sizeof(int));
+        copied += taken;
+        offset = 0;
+    }
+
+    return copy;
+}
+
+/*
+ * Description:
+ *    - Sorts the elements of every node as one sequence.
+ *    - Each node is sorted with the given option, then all nodes are k-way merged through a loser tree.
+ *    - Without output, the merged sequence is written back over the nodes from head to tail, keeping every node's size.
+ *
+ * Parameters:
+ *    - list_ptr => pointer to the list
+ *    - option => per node sort, see list_sort
+ *    - output => 0x0: redistribute into the nodes | buffer of list_count elements receiving the sequence
+ *    - threads => workers sorting nodes in parallel (1: calling thread only)
+ *
+ * Time Complexity: O(total log total / threads + total log node)
+ */
+void list_sort_all(list_ptr *li, int option, int *output, int threads) {
+    if (!li || option < 0 || option > 3 || li->length == 0 || !unrolledindexcmp_1(li)) return;
+
+    int count = li->length;
+    int total = li->cumulative[count];
+    list_t **nodes = (list_t **) malloc(count * sizeof(list_t *));
+    int *merged = (output) ? output : (int *) malloc(total * sizeof(int));
+    if (!nodes || !merged) {
+        free(nodes);
+        if (merged != output) free(merged);
+        return;
+    }
+    memcpy(nodes, li->directory, count * sizeof(list_t *));
+
+    parallelcmp_3(nodes, count, sortallcmp_1, &option, threads);
+    int ok = losertreecmp_2(nodes, count, merged);
+
+    if (!output && ok) { // every node gets a slice of the merged sequence, sorted in turn
+        int offset = 0;
+        for (int i = 0; i < count; i++) {
+            memcpy(nodes[i]->array, merged + offset, nodes[i]->size * sizeof(int));
+            nodetouchcmp_1(nodes[i]);
+            nodesortedcmp_1(nodes[i]);
+            offset += nodes[i]->size;
+        }
+    }
+    if (!output) free(merged);
+    free(nodes);
+}
+
+/*
+ * Description:
+ *    - Searches every node for elements equal to any target.
+ *    - Hits are ordered by node from the head, then by offset. Must free manually afterward.
+ *    - Nodes whose [min, max] excludes every target are skipped (summaries are built on the first call).
+ *
+ * Parameters:
+ *    - list_ptr => pointer to the list
+ *    - target => pointer to group of target number
+ *    - target_size => group of target number's size
+ *    - threads => workers searching nodes in parallel (1: calling thread only)
+ *    - hits_size => receives the number of hits
+ *
+ * Return: pointer to the hits | 0x0 (no hit)
+ * Time Complexity: O(total * target_size / threads)
+ */
+list_hit *list_find_all(list_ptr *li, int *target, int target_size, int threads, int *hits_size) {
+    if (hits_size) *hits_size = 0;
+    if (!li || !target || target_size <= 0 || !hits_size || li->length == 0 || !unrolledindexcmp_1(li)) return 0x0;
+
+    int count = li->length;
+    list_t **nodes = (list_t **) malloc(count * sizeof(list_t *));
+    list_find_job job = {target, target_size, (int **) calloc(count, sizeof(int *)), (int *) calloc(count, sizeof(int))};
+    if (!nodes || !job.offsets || !job.found) {
+        free(nodes);
+        free(job.offsets);
+        free(job.found);
+        return 0x0;
+    }
+    memcpy(nodes, li->directory, count * sizeof(list_t *));
+
+    parallelcmp_3(nodes, count, findallcmp_1, &job, threads);
+
+    int found = 0;
+    for (int i = 0; i < count; i++) found += job.found[i];
+
+    list_hit *hits = (found) ? (list_hit *) malloc(found * sizeof(list_hit)) : 0x0;
+    int k = 0;
+    for (int i = 0; i < count; i++) {
+        for (int j = 0; hits && j < job.found[i]; j++) {
+            hits[k].node = i;
+            hits[k++].offset = job.offsets[i][j];
+        }
+        free(job.offsets[i]);
     }
 
-    return -1;
+    free(nodes);
+    free(job.offsets);
+    free(job.found);
+
+    if (hits) *hits_size = found;
+    return hits;
+}
+
+/*
+ * Description:
+ *    - Calls fn(node, position, ctx) once for every node, on several threads.
+ *    - The node set is snapshotted first; position counts from the head.
+ *    - Nodes are dealt to per-worker deques balanced by node size, idle workers steal from the others.
+ *    - fn must not push, pop, insert or delete nodes.
+ *
+ * Parameters:
+ *    - list_ptr => pointer to the list
+ *    - fn => function applied to each node
+ *    - ctx => passed through to fn
+ *    - threads => number of workers, the calling thread included
+ *
+ * Time Complexity: O(node log node + total work / threads)
+ */
+void list_for_each_parallel(list_ptr *li, void (*fn)(list_t *, int, void *), void *ctx, int threads) {
+    if (!li || !fn || li->length == 0 || !unrolledindexcmp_1(li)) return;
+
+    int count = li->length;
+    list_t **nodes = (list_t **) malloc(count * sizeof(list_t *));
+    if (!nodes) return;
+    memcpy(nodes, li->directory, count * sizeof(list_t *));
+
+    parallelcmp_3(nodes, count, fn, ctx, threads);
+    free(nodes);
+}
+
+/*
+ * Sorts every node on its own, in parallel.
+ * Parameters:
+ *    - list_ptr => pointer to the list
+ *    - option => see list_sort
+ *    - threads => number of workers, the calling thread included
+ *
+ * Time Complexity: O(total log array_size / threads)
+ */
+void list_sort_each(list_ptr *li, int option, int threads) {
+    if (option < 0 || option > 3) return;
+    list_for_each_parallel(li, sortallcmp_1, &option, threads);
 }
 
 /*
- * Retrieves the array from a specific list. Must free manually afterward.
- * To access the last element, set start and end to -1.
+ * Searches every node on its own, in parallel.
+ * Nodes whose [min, max] excludes every target are skipped, sorted nodes are binary searched (see list_summary).
  * Parameters:
  *    - list_ptr => pointer to the list
- *    - index => 0: forward | -1: backward
- *    - start, end => retrieve range
+ *    - target => pointer to group of target number
+ *    - target_size => group of target number's size
+ *    - option => 0: linear search | 1: binary search (sorted array) | 2: hash lookup (LIST_HASHED, linear otherwise)
+ *    - result => receives, per node from the head, its first match or 0xFFFFFFFF
+ *    - threads => number of workers, the calling thread included
  *
- * Return: copy of pointer to the array
- * Time Complexity: O(index + retrieve_size)
+ * Time Complexity: O(total * target_size / threads) linear | O(node * log array_size * target_size / threads) binary
  */
-int *list_retrieve(list_ptr *li, int index, int start, int end) {
-    if (!li || start > end) return 0x0;
-
-    list_t *current = (index >= 0) ? li->head : li->tail;
-    int count = (index >= 0) ? 0 : -1;
-
-    while (current != 0x0) {
-        if (count == index) {
-            if (end >= current->size) return 0x0;
-
-            if (start == -1 && end == -1) {
-                int *scopy = (int *) malloc(sizeof(int));
-                scopy[0] = current->array[current->size - 1];
-                return scopy;
-            }
-
-            if (start < 0 || end < 0) return 0x0;
+void list_find_each(list_ptr *li, int *target, int target_size, int option, int *result, int threads) {
+    if (!target || target_size <= 0 || !result) return;
 
-            int *copy = (int *) malloc((end - start + 1) * sizeof(int));
-            for (int i = start; i <= end; i++) copy[i - start] = current->array[i];
-            return copy;
-        }
+    list_find_each_job job = {target, target_size, option, result};
+    list_for_each_parallel(li, findeachcmp_1, &job, threads);
+}
 
-        current = (index >= 0) ? current->nxt : current->prev;
-        count += (index >= 0) ? 1 : -1;
-    }
+/*
+ * Writes the same input array to the same range of every node, in parallel.
+ * Parameters:
+ *    - list_ptr => pointer to the list
+ *    - start, end => write range, see list_write
+ *    - input => pointer to the input array
+ *    - reserved => number of extra elements to pre-allocate on resize
+ *    - threads => number of workers, the calling thread included
+ *
+ * Time Complexity: O(node * input_size / threads)
+ */
+void list_write_each(list_ptr *li, int start, int end, int *input, int reserved, int threads) {
+    if (!li || !input || start > end) return;
 
-    return 0x0;
+    list_write_each_job job = {start, end, input, reserved};
+    list_for_each_parallel(li, writeeachcmp_1, &job, threads);
+    li->indexed = 0;
 }
 
 /*
@@ -505,7 +3829,7 @@ int *list_retrieve(list_ptr *li, int index, int start, int end) {
  *    - If the selected node is deleted, the iterator becomes invalid.
  *    - Iterator's insert and delete function does not move iterator itself.
  *    - Iterator's move function is the only way to move iterator.
- *    - 9 Avaliable built in features: insert, delete, move, write, erase, retrieve, sort, find, size
+ *    - 11 Avaliable built in features: insert, delete, move, write, erase, retrieve, borrow, sort, find, reduce, size
  * 
  * Parameters:
  *    - list_ptr => pointer to the list
@@ -517,19 +3841,16 @@ int *list_retrieve(list_ptr *li, int index, int start, int end) {
 iterator_ptr *iterator_init(list_ptr *li, int index) {
     if (!li) return 0x0;
 
-    list_t *current = (index >= 0) ? li->tail : li->head;
-    int count = (index >= 0) ? 0 : -1;
-    while (current != 0x0) {
-        if (count == index) {
-            iterator_ptr *a = (iterator_ptr *) malloc(sizeof(iterator_ptr));
-            a->points = current;
-            return a;
-        }
-        current = (index >= 0) ? current->nxt : current->prev;
-        count += (index >= 0) ? 1 : -1;
-    }
+    int phase = safeentercmp_1(li);
+    iterator_ptr end = {__atomic_load_n((index >= 0) ? &li->tail : &li->head, __ATOMIC_ACQUIRE), li};
+    list_t *current = iteratorlocatecmp_1(&end, index);
+    safeleavecmp_1(li, phase); // the caller keeps the node alive from here, see list_threadsafe
+    if (!current) return 0x0;
 
-    return 0x0;
+    iterator_ptr *a = (iterator_ptr *) malloc(sizeof(iterator_ptr));
+    a->points = current;
+    a->origin = li;
+    return a;
 }
 
 /*
@@ -543,12 +3864,20 @@ iterator_ptr *iterator_init(list_ptr *li, int index) {
  * Time Complexity: O(array_size)
  */
 void iterator_insert(list_ptr *origin, iterator_ptr *li, int size, int *input) {
-    if (!li || !li->points || !origin) return;
+    if (!li || !li->points || !origin || size <= 0 || !input) return;
+
+    list_t *a = nodeacquirecmp_1((origin->threadsafe) ? 0x0 : origin, size);
+    if (!a) return;
 
-    list_t *a = (list_t *) malloc(sizeof(list_t));
-    a->array = (int *) malloc(size * sizeof(int));
     a->size = size;
-    for (int i = 0; i < size; i++) a->array[i] = input[i];
+    memcpy(a->array, input, size * sizeof(int));
+
+    if (origin->threadsafe) {
+        int phase = safeentercmp_1(origin);
+        safeinsertcmp_1(origin, li->points, a);
+        safeleavecmp_1(origin, phase);
+        return;
+    }
 
     a->nxt = li->points;
     a->prev = li->points->prev;
@@ -556,6 +3885,8 @@ void iterator_insert(list_ptr *origin, iterator_ptr *li, int size, int *input) {
     if (li->points->prev == 0x0) origin->tail = a; else li->points->prev->nxt = a;
     li->points->prev = a;
     origin->length++;
+    origin->indexed = 0;
+    origin->finger = 0x0;
 
     // insert at head is not supported. selector requires selected node1 to insert into. if there is not, the selector becomes inarrayid. free(<iterator_ptr>); to exit.
 }
@@ -569,7 +3900,16 @@ void iterator_insert(list_ptr *origin, iterator_ptr *li, int size, int *input) {
  * Time Complexity: O(1)
  */
 void iterator_delete(list_ptr *origin, iterator_ptr *li) {
-    if (!li || !li->points || !origin || li->points->prev == 0x0) return;
+    if (!li || !li->points || !origin) return;
+
+    if (origin->threadsafe) {
+        int phase = safeentercmp_1(origin);
+        safedeletecmp_1(origin, li->points);
+        safeleavecmp_1(origin, phase);
+        return;
+    }
+
+    if (li->points->prev == 0x0) return;
 
     list_t *tmp = li->points->prev; // hold
 
@@ -582,9 +3922,10 @@ void iterator_delete(list_ptr *origin, iterator_ptr *li) {
         origin->tail = li->points;
     }
 
-    free(tmp->array);
-    free(tmp);
+    nodereleasecmp_1(origin, tmp);
     origin->length--;
+    origin->indexed = 0;
+    origin->finger = 0x0;
 }
 
 /*
@@ -598,15 +3939,41 @@ void iterator_delete(list_ptr *origin, iterator_ptr *li) {
 void iterator_move(iterator_ptr *li, int index) {
     if (!li || !li->points) return;
 
+    int phase;
+    list_t *current = iteratorlocatecmp_2(li, index, &phase);
+    if (!current) return;
+    li->points = current;
+    safeleavecmp_1(li->origin, phase);
+}
+
+/*
+ * Description:
+ *    - Calls fn(node, position, ctx) on every node from the iterator's node to the end of the list.
+ *    - Arrays LIST_PREFETCH_DISTANCE nodes ahead are prefetched while fn works on the current node.
+ *
+ * Parameters:
+ *    - iterator_ptr => pointer to the iterator
+ *    - index => 0: forward | -1: backward (start from current node)
+ *    - fn => callback, position counts the nodes already visited
+ *    - ctx => passed through to fn
+ *
+ * Time Complexity: O(node * fn)
+ */
+void iterator_for_each(iterator_ptr *li, int index, void (*fn)(list_t *, int, void *), void *ctx) {
+    if (!li || !fn) return;
+
     list_t *current = li->points;
-    int count = (index >= 0) ? 0 : -1;
-    while (current != 0x0) {
-        if (count == index) {
-            li->points = current;
-            return;
+    list_t *ahead = li->points;
+    for (int i = 0; i < LIST_PREFETCH_DISTANCE && ahead != 0x0; i++) ahead = (index >= 0) ? ahead->nxt : ahead->prev;
+
+    for (int position = 0; current != 0x0; position++) {
+        if (ahead) {
+            __builtin_prefetch(ahead->array);
+            ahead = (index >= 0) ? ahead->nxt : ahead->prev;
         }
+
+        fn(current, position, ctx);
         current = (index >= 0) ? current->nxt : current->prev;
-        count += (index >= 0) ? 1 : -1;
     }
 }
 
@@ -615,6 +3982,7 @@ void iterator_move(iterator_ptr *li, int index) {
  *    - Writes the input array to a specific range in a specific list (from iterator).
  *    - To access the last element, set start and end to -1.
  *    - Automatically resizes the array if end_location exceeds its current size, with extra memory reserved (optional).
+ *    - Capacity at least doubles on each resize, so writing one element past the end at a time is amortized O(1).
  *
  * Parameters:
  *    - iterator_ptr => pointer to the iterator
@@ -627,36 +3995,21 @@ void iterator_move(iterator_ptr *li, int index) {
  */
 void iterator_write(iterator_ptr *li, int index, int start, int end, int *input, int reserved) {
     if (!li || !li->points || start > end) return;
-    
-    list_t *current = li->points;
-    int count = (index >= 0) ? 0 : -1;
-    while (current != 0x0) {
-        if (count == index) {
-            if (start == -1 && end == -1) {
-                current->array[current->size - 1] = input[0];
-                return;
-            }
-
-            if (start < 0) return;
-
-            if (end >= current->size) {
-                if (reserved < 0) return;
-
-                int *new_array = (int*) realloc(current->array, ((end + 1) + reserved) * sizeof(int));
-                current->array = new_array;
-
-                for (int i = 0; i < reserved; i++) current->array[(end + 1) + i] = 0xFFFFFFFF;
-
-                current->size = (end + 1) + reserved;
-            }
-
-            for (int i = start; i <= end; i++) current->array[i] = input[i - start];
-            return;
-        }
-
-        current = (index >= 0) ? current->nxt : current->prev;
-        count += (index >= 0) ? 1 : -1;
+    int phase;
+    list_t *current = iteratorlocatecmp_2(li, index, &phase);
+    if (!current) return;
+
+    if (iteratorsafecmp_1(li)) {
+        nodeentercmp_1(current);
+        if (start >= 0 && end >= current->size && reserved >= 0) nodegrowcmp_2(li->origin, current, nodegrowthcmp_1(current, (end + 1) + reserved));
+        if (writecmp_1(current, start, end, input, reserved)) __atomic_store_n(&li->origin->indexed, 0, __ATOMIC_RELAXED);
+        nodeleavecmp_1(current);
+        safeleavecmp_1(li->origin, phase);
+        return;
     }
+
+    if (writecmp_1(current, start, end, input, reserved) && li->origin) li->origin->indexed = 0;
+    safeleavecmp_1(li->origin, phase);
 }
 
 /*
@@ -670,17 +4023,14 @@ void iterator_write(iterator_ptr *li, int index, int start, int end, int *input,
  * Time Complexity: O(index)
  */
 int iterator_size(iterator_ptr *li, int index) {
-    if (!li) return;
-
-    list_t *current = li->points;
-    int count = (index >= 0) ? 0 : -1;
-
-    while (current != 0x0) {
-        if (count == index) return current->size;
-
-        current = (index >= 0) ? current->nxt : current->prev;
-        count += (index >= 0) ? 1 : -1;
-    }
+    if (!li) return -1;
+    int phase;
+    list_t *current = iteratorlocatecmp_2(li, index, &phase);
+    if (!current) return -1;
+
+    int size = (iteratorsafecmp_1(li)) ? __atomic_load_n(&current->size, __ATOMIC_ACQUIRE) : current->size;
+    safeleavecmp_1(li->origin, phase);
+    return size;
 }
 
 /*
@@ -688,13 +4038,13 @@ int iterator_size(iterator_ptr *li, int index) {
  *    - Deletes element in a specific range, list (from iterator). 
  *    - To access the last element, set start and end to -1.
  *    - Deleting from the end is recommended as it avoids shifting elements. 
- *    - Deleting from the start requires moving other elements to fill the gap.
+ *    - Deleting from the start moves the following elements down with one memmove to fill the gap.
  *
  * Parameters:
  *    - iterator_ptr => pointer to the itertor 
  *    - index => 0: forward | -1: backward (start from current node)
  *    - start, end => erase range
- *    - free_memory => FALSE | TRUE
+ *    - free_memory => FALSE | TRUE (the array is only reallocated once it is at most a quarter full)
  *
  * Time Complexity: 
  *    - O(index + array_size) in the worst case
@@ -702,41 +4052,69 @@ int iterator_size(iterator_ptr *li, int index) {
  */
 void iterator_erase(iterator_ptr *li, int index, int start, int end, int free_memory) {
     if (!li || start > end) return;
+    int phase;
+    list_t *current = iteratorlocatecmp_2(li, index, &phase);
+    if (!current) return;
+
+    if (iteratorsafecmp_1(li)) {
+        nodeentercmp_1(current);
+        if (erasecmp_1(current, start, end, free_memory, TRUE)) __atomic_store_n(&li->origin->indexed, 0, __ATOMIC_RELAXED);
+        nodeleavecmp_1(current);
+        safeleavecmp_1(li->origin, phase);
+        return;
+    }
 
-    list_t *current = li->points;
-    int count = (index >= 0) ? 0 : -1;
-
-    while (current != 0x0) {
-        if (count == index) {
-            if (start == -1 && end == -1) {
-                current->array[current->size - 1] = 0xFFFFFFFF;
-
-                if (free_memory) {
-                    int *new_array = (int*) realloc(current->array, current->size - 1 * sizeof(int));
-                    current->array = new_array;
-                    current->size--;
-                }
-                return;
-            }
+    if (erasecmp_1(current, start, end, free_memory, FALSE) && li->origin) li->origin->indexed = 0;
+    safeleavecmp_1(li->origin, phase);
+}
 
-            if (start < 0) return;
+/*
+ * Description:
+ *    - Grows a specific list's array to hold at least capacity elements, without changing its size (from iterator).
+ *    - Writes up to that capacity then never reallocate.
+ *
+ * Parameters:
+ *    - iterator_ptr => pointer to the iterator
+ *    - index => 0: forward | -1: backward (start from current node)
+ *    - capacity => number of elements to make room for
+ *
+ * Time Complexity: O(index + array_size)
+ */
+void iterator_reserve(iterator_ptr *li, int index, int capacity) {
+    if (!li || capacity <= 0) return;
+    int phase;
+    list_t *current = iteratorlocatecmp_2(li, index, &phase);
+    if (!current) return;
+
+    if (iteratorsafecmp_1(li)) {
+        nodeentercmp_1(current);
+        nodegrowcmp_2(li->origin, current, capacity);
+        nodeleavecmp_1(current);
+        safeleavecmp_1(li->origin, phase);
+        return;
+    }
 
-            for (int i = end + 1; i < current->size; i++) {
-                current->array[i - (end - start + 1)] = current->array[i];
-                current->array[i] = 0xFFFFFFFF;
-            }
+    nodegrowcmp_1(current, capacity);
+    safeleavecmp_1(li->origin, phase);
+}
 
-            if (free_memory) {
-                int *new_array = (int*) realloc(current->array, (current->size - (end - start + 1)) * sizeof(int));
-                current->array = new_array;
-                current->size -= (end - start + 1);
-            }
-            return;
-        }
+/*
+ * Description:
+ *    - Releases the unused capacity of a specific list's array, moving it back inside the node when it fits (from iterator).
+ *    - Does nothing on a thread-safe list, where readers may still hold the array.
+ *
+ * Parameters:
+ *    - iterator_ptr => pointer to the iterator
+ *    - index => 0: forward | -1: backward (start from current node)
+ *
+ * Time Complexity: O(index + array_size)
+ */
+void iterator_shrink(iterator_ptr *li, int index) {
+    if (!li || iteratorsafecmp_1(li)) return;
+    list_t *current = iteratorlocatecmp_1(li, index);
+    if (!current) return;
 
-        current = (index >= 0) ? current->nxt : current->prev;
-        count += (index >= 0) ? 1 : -1;
-    }
+    nodefitcmp_1(current, current->size);
 }
 
 /*
@@ -744,34 +4122,25 @@ void iterator_erase(iterator_ptr *li, int index, int start, int end, int free_me
  * Parameters:
  *    - iterator_ptr => pointer to the iterator
  *    - index => 0: forward | -1: backward (start from current node)
- *    - option => 0: bubble | 1: merge (recommended)
+ *    - option => 0: bubble | 1: merge | 2: radix (recommended) | 3: introsort (in place)
  *
  * Time Complexity:
  *    - bubble: O(1) best case | O(array_size^2) worst case
- *    - merge: O(array_size log array_size) all cases
+ *    - merge: O(array_size log array_size) all cases, one array_size scratch buffer
+ *    - radix: O(array_size) all cases, one array_size scratch buffer
+ *    - introsort: O(array_size log array_size) all cases, no scratch buffer
  */
 void iterator_sort(iterator_ptr *li, int index, int option) {
     if (!li) return;
-    list_t *current = li->points;
-    int count = (index >= 0) ? 0 : -1;
-
-    while (current != 0x0) {
-        if (count == index) {
-            switch (option) {
-                case 0:
-                    bubblesortcmp_1(current);
-                    return;
-                case 1:
-                    mergesortcmp_2(current->array, 0, current->size - 1);
-                    return;
-                default:
-                    return;
-            }
-        }
-
-        current = (index >= 0) ? current->nxt : current->prev;
-        count += (index >= 0) ? 1 : -1;
-    }
+    int phase;
+    list_t *current = iteratorlocatecmp_2(li, index, &phase);
+    if (!current) return;
+
+    int safe = iteratorsafecmp_1(li);
+    if (safe) nodeentercmp_1(current);
+    sortcmp_1(current, option);
+    if (safe) nodeleavecmp_1(current);
+    safeleavecmp_1(li->origin, phase);
 }
 
 /*
@@ -782,38 +4151,227 @@ void iterator_sort(iterator_ptr *li, int index, int option) {
  *    - start, end => search range (linear search supports backward searching)
  *    - target => pointer to group of target number
  *    - target_size => group of target number's size
- *    - option => 0: linear search | 1: binary search (sorted array)
+ *    - option => 0: linear search | 1: binary search (sorted array) | 2: hash lookup (LIST_HASHED, linear otherwise)
  *    - returnType => 0: index | 1: boolean
  * 
  * Return: (index | 0xFFFFFFFF) | (TRUE | FALSE) | -1 (Invalid)
  * Time Complexity:
  *    - linear search: O(index) best case | O(index + search_range * target_size) worst case
+ *      (compares 8 elements per instruction with avx2, 4 with sse2, selected at runtime)
  *    - binary search: O(index + log search_range * target_size) all cases
+ *      (branchless; nodes hinted LIST_READ_MOSTLY search a cached eytzinger layout instead)
+ *    - hash lookup: O(index + target_size) expected, plus O(array_size) to build the hash once
+ *      (the thread-safe mode searches linearly instead)
+ *    - with a summary (list_sort, list_summary): linear searches forward on a sorted array run as binary searches,
+ *      and O(index + target_size) when every target lies outside [min, max]
  */
 int iterator_find(iterator_ptr *li, int index, int start, int end, int *target, int target_size, int option, int returnType) {
+    if (!li || option < 0 || option > 2) return -1;
+    int phase;
+    list_t *current = iteratorlocatecmp_2(li, index, &phase);
+    if (!current) return -1;
+
+    int safe = iteratorsafecmp_1(li);
+    list_t view, *node = current;
+    unsigned int seq = 0;
+    int result;
+
+    do {
+        if (safe) {
+            seq = nodesnapshotcmp_1(current, &view);
+            node = &view;
+        }
+        result = findcmp_1(node, start, end, target, target_size, option);
+    } while (safe && !nodevalidatecmp_1(current, seq));
+    safeleavecmp_1(li->origin, phase);
+
+    return (returnType) ? (result == 0xFFFFFFFF) ? FALSE : TRUE : result;
+}
+
+/*
+ * Description:
+ *    - Reads the summary of a specific list: its smallest and largest element, and whether it is sorted (from iterator).
+ *    - Computed in one pass on first use and kept until the array changes. iterator_sort sets it at no cost.
+ *    - With a summary, linear searches on a sorted array run as binary searches,
+ *      and searches return at once when every target lies outside [min, max].
+ *
+ * Parameters:
+ *    - iterator_ptr => pointer to the iterator
+ *    - index => 0: forward | -1: backward (start from current node)
+ *    - min, max => receive the smallest and largest element (optional: 0x0)
+ *
+ * Return: TRUE (sorted) | FALSE (unsorted) | -1 (Invalid)
+ * Time Complexity: O(index + array_size) first call | O(index) afterward
+ */
+int iterator_summary(iterator_ptr *li, int index, int *min, int *max) {
+    if (!li) return -1;
+    int phase;
+    list_t *current = iteratorlocatecmp_2(li, index, &phase);
+    if (!current) return -1;
+
+    int safe = iteratorsafecmp_1(li);
+    if (safe) nodeentercmp_1(current);
+    nodesummarycmp_1(current);
+    if (min) *min = current->min;
+    if (max) *max = current->max;
+    int sorted = (current->flags & LIST_SORTED) ? TRUE : FALSE;
+    if (safe) nodeleavecmp_1(current);
+    safeleavecmp_1(li->origin, phase);
+
+    return sorted;
+}
+
+/*
+ * Description:
+ *    - Sets access hints on a specific list.
+ *    - LIST_READ_MOSTLY: binary searches build and keep an eytzinger copy of the (sorted) array,
+ *      trading one extra array_size of memory for fewer cache misses per search. Any write drops the copy.
+ *    - LIST_HASHED: hash lookups (find option 2) keep a hash from value to positions, built on first use.
+ *      Writes and erases at the end update it in place, larger changes rebuild it. Costs 4 to 8 array_size of memory.
+ *
+ * Parameters:
+ *    - iterator_ptr => pointer to the iterator
+ *    - index => 0: forward | -1: backward (start from current node)
+ *    - hint => 0 | LIST_READ_MOSTLY | LIST_HASHED (combinable)
+ *
+ * Time Complexity: O(index)
+ */
+void iterator_hint(iterator_ptr *li, int index, int hint) {
     if (!li) return;
-    list_t *current = li->points;
-    int count = (index >= 0) ? 0 : -1;
+    int phase;
+    list_t *current = iteratorlocatecmp_2(li, index, &phase);
+    if (!current) return;
+
+    int safe = iteratorsafecmp_1(li);
+    if (safe) nodeentercmp_1(current);
+    if (!(hint & LIST_READ_MOSTLY)) nodelayoutdropcmp_1(current);
+    if (!(hint & LIST_HASHED)) indexdropcmp_1(current);
+    current->flags = (current->flags & ~(LIST_READ_MOSTLY | LIST_HASHED)) | (hint & (LIST_READ_MOSTLY | LIST_HASHED));
+    if (safe) nodeleavecmp_1(current);
+    safeleavecmp_1(li->origin, phase);
+}
 
-    while (current != 0x0) {
-        if (count == index) {
-            switch (option) {
-                case 0:
-                    int result = linearsearchcmp_1(current, start, end, target, target_size);
-                    return (returnType) ? (result == 0xFFFFFFFF) ? FALSE : TRUE : result;
-                case 1:
-                    int result = binarysearchcmp_1(current, start, end, target, target_size);
-                    return (returnType) ? (result == 0xFFFFFFFF) ? FALSE : TRUE : result;
-                default:
-                    return -1;
-            }
+/*
+ * Description:
+ *    - Binary searches many targets in a specific list (sorted array, from iterator) in one call.
+ *    - Searches advance in lockstep, so their memory accesses overlap instead of queueing.
+ *
+ * Parameters:
+ *    - iterator_ptr => pointer to the iterator
+ *    - index => 0: forward | -1: backward (start from current node)
+ *    - start, end => search range
+ *    - target => pointer to the targets
+ *    - target_size => number of targets
+ *    - result => receives, per target, its first index or 0xFFFFFFFF
+ *
+ * Return: number of targets found | -1 (Invalid)
+ * Time Complexity: O(index + target_size * log search_range)
+ */
+int iterator_find_batch(iterator_ptr *li, int index, int start, int end, int *target, int target_size, int *result) {
+    if (!li || !target || !result || target_size < 0) return -1;
+    int phase;
+    list_t *current = iteratorlocatecmp_2(li, index, &phase);
+    if (!current) return -1;
+
+    int safe = iteratorsafecmp_1(li);
+    list_t view, *node = current;
+    unsigned int seq = 0;
+    int valid;
+
+    do {
+        if (safe) {
+            seq = nodesnapshotcmp_1(current, &view);
+            node = &view;
         }
+        valid = (start >= 0 && start <= end && end < node->size);
+        if (valid) binarysearchcmp_4(node, start, end, target, target_size, result);
+    } while (safe && !nodevalidatecmp_1(current, seq));
+    safeleavecmp_1(li->origin, phase);
 
-        current = (index >= 0) ? current->nxt : current->prev;
-        count += (index >= 0) ? 1 : -1;
-    }
+    if (!valid) return -1;
+
+    int found = 0;
+    for (int i = 0; i < target_size; i++) found += (result[i] != 0xFFFFFFFF);
+    return found;
+}
+
+
+/*
+ * Description:
+ *    - Sums a range of a specific list and finds its smallest and largest element and how many elements equal value (from iterator), see list_reduce.
+ *
+ * Parameters:
+ *    - iterator_ptr => pointer to the iterator
+ *    - index => 0: forward | -1: backward (start from current node)
+ *    - start, end => reduce range
+ *    - value => element to count
+ *    - threads => threads to use at most, counting the caller (0, 1: caller only)
+ *    - result => receives the sum, min, max, their first index, and the count
+ *
+ * Return: TRUE | FALSE (Invalid)
+ * Time Complexity: O(index + reduce_range / threads)
+ */
+int iterator_reduce(iterator_ptr *li, int index, int start, int end, int value, int threads, list_reduction *result) {
+    if (!li || !result) return FALSE;
+    int phase;
+    list_t *current = iteratorlocatecmp_2(li, index, &phase);
+    if (!current) return FALSE;
+
+    int safe = iteratorsafecmp_1(li);
+    list_t view, *node = current;
+    unsigned int seq = 0;
+    int valid;
+
+    do {
+        if (safe) {
+            seq = nodesnapshotcmp_1(current, &view);
+            node = &view;
+        }
+        valid = (start >= 0 && start <= end && end < node->size);
+        if (valid) reducecmp_3(node->array, start, end, value, threads, result);
+    } while (safe && !nodevalidatecmp_1(current, seq));
+    safeleavecmp_1(li->origin, phase);
+
+    return valid;
+}
+
+/*
+ * Description:
+ *    - Counts the elements of a range of a specific list into buckets of equal width (from iterator), see list_histogram.
+ *
+ * Parameters:
+ *    - iterator_ptr => pointer to the iterator
+ *    - index => 0: forward | -1: backward (start from current node)
+ *    - start, end => histogram range
+ *    - low => smallest element of the first bucket
+ *    - width => elements per bucket
+ *    - buckets => number of buckets
+ *    - counts => receives buckets counts (cleared first)
+ *
+ * Return: number of elements counted | -1 (Invalid)
+ * Time Complexity: O(index + histogram_range + buckets)
+ */
+int iterator_histogram(iterator_ptr *li, int index, int start, int end, int low, int width, int buckets, int *counts) {
+    if (!li || !counts || width <= 0 || buckets <= 0) return -1;
+    int phase;
+    list_t *current = iteratorlocatecmp_2(li, index, &phase);
+    if (!current) return -1;
+
+    int safe = iteratorsafecmp_1(li);
+    list_t view, *node = current;
+    unsigned int seq = 0;
+    int counted;
+
+    do {
+        if (safe) {
+            seq = nodesnapshotcmp_1(current, &view);
+            node = &view;
+        }
+        counted = (start >= 0 && start <= end && end < node->size) ? histogramcmp_1(node->array, start, end, low, width, buckets, counts) : -1;
+    } while (safe && !nodevalidatecmp_1(current, seq));
+    safeleavecmp_1(li->origin, phase);
 
-    return -1;
+    return counted;
 }
 
 /*
@@ -830,31 +4388,190 @@ int iterator_find(iterator_ptr *li, int index, int start, int end, int *target,
 int *iterator_retrieve(iterator_ptr *li, int index, int start, int end) {
     if (!li || start > end) return 0x0;
 
-    list_t *current = li->points;
-    int count = (index >= 0) ? 0 : -1;
+    int last = (start == -1 && end == -1);
+    if (!last && (start < 0 || end < 0)) return 0x0;
 
-    while (current != 0x0) {
-        if (count == index) {
-            if (end >= current->size) return 0x0;
+    int count = (last) ? 1 : end - start + 1;
+    int *copy = (int *) malloc(count * sizeof(int));
+    if (!copy) return 0x0;
 
-            if (start == -1 && end == -1) {
-                int *scopy = (int *) malloc(sizeof(int));
-                scopy[0] = current->array[current->size - 1];
-                return scopy;
-            }
+    int phase;
+    list_t *current = iteratorlocatecmp_2(li, index, &phase);
+    if (!current) {
+        free(copy);
+        return 0x0;
+    }
 
-            if (start < 0 || end < 0) return 0x0;
+    int safe = iteratorsafecmp_1(li);
+    list_t view, *node = current;
+    unsigned int seq = 0;
+    int valid;
 
-            int *copy = (int *) malloc((end - start + 1) * sizeof(int));
-            for (int i = start; i <= end; i++) copy[i - start] = current->array[i];
-            return copy;
+    do {
+        if (safe) {
+            seq = nodesnapshotcmp_1(current, &view);
+            node = &view;
         }
+        valid = (end < node->size && node->size > 0);
+        if (valid) memcpy(copy, node->array + ((last) ? node->size - 1 : start), count * sizeof(int));
+    } while (safe && !nodevalidatecmp_1(current, seq));
+    safeleavecmp_1(li->origin, phase);
+
+    if (!valid) {
+        free(copy);
+        return 0x0;
+    }
+    return copy;
+}
 
-        current = (index >= 0) ? current->nxt : current->prev;
-        count += (index >= 0) ? 1 : -1;
+/*
+ * Description:
+ *    - Borrows a range of a specific list without copying it (from iterator), see list_borrow.
+ *    - Not available in thread-safe mode, where arrays can move under the caller: use iterator_retrieve there.
+ *
+ * Parameters:
+ *    - iterator_ptr => pointer to the iterator
+ *    - index => 0: forward | -1: backward (start from current node)
+ *    - start, end => borrow range
+ *
+ * Return: span over the range | span with ptr 0x0 (Invalid)
+ * Time Complexity: O(index)
+ */
+list_span iterator_borrow(iterator_ptr *li, int index, int start, int end) {
+    list_span span = {0x0, 0, 0x0, 0};
+    if (!li || iteratorsafecmp_1(li)) return span;
+    return spancmp_1(iteratorlocatecmp_1(li, index), start, end);
+}
+
+/*
+ * Description:
+ *    - Moves the nodes from first to last out of src and into dst, behind pos (tail side, as iterator_insert does).
+ *    - first must be on the head side of last. Nodes are relinked, never copied, and first and last then belong to dst.
+ *    - dst and src may be the same list, as long as pos is not one of the moved nodes.
+ *    - first and last must have been created from src, and pos from dst. Neither list may be in thread-safe mode.
+ *    - Only first and last follow the nodes to dst. Any other iterator on a moved node still names src as its origin,
+ *      so it must be created again (or its origin set to dst) before it is used.
+ *
+ * Parameters:
+ *    - list_ptr => pointer to the destination list
+ *    - iterator_ptr => pointer to the node to insert behind | 0x0: the tail of dst
+ *    - list_ptr => pointer to the source list
+ *    - iterator_ptr => pointers to the first and last node to move
+ *
+ * Return: number of nodes moved | -1 (Invalid)
+ * Time Complexity: O(moved node) (to count them)
+ */
+int list_splice(list_ptr *dst, iterator_ptr *pos, list_ptr *src, iterator_ptr *first, iterator_ptr *last) {
+    if (!dst || !src || !first || !last || !first->points || !last->points || (pos && !pos->points)) return -1;
+    if (first->origin != src || last->origin != src || (pos && pos->origin != dst)) return -1;
+    if (src->threadsafe || dst->threadsafe) return -1;
+
+    list_t *head = first->points;
+    list_t *tail = last->points;
+    list_t *at = (pos) ? pos->points : 0x0;
+
+    int count = 1;
+    for (list_t *current = head; current != tail; count++) { // also checks that last lies behind first
+        if (current == at) return -1;
+        current = current->prev;
+        if (!current) return -1;
     }
+    if (tail == at) return -1;
+    if ((!head->nxt && head != src->head) || (!tail->prev && tail != src->tail)) return -1; // ends of another list
+
+    if (head->nxt) head->nxt->prev = tail->prev; else src->head = tail->prev;
+    if (tail->prev) tail->prev->nxt = head->nxt; else src->tail = head->nxt;
+    src->length -= count;
+    src->indexed = 0;
+    src->finger = 0x0;
+
+    list_t *front = (at) ? at : dst->tail; // neighbours of the chain once linked
+    list_t *back = (at) ? at->prev : 0x0;
+
+    head->nxt = front;
+    tail->prev = back;
+    if (front) front->prev = head; else dst->head = head;
+    if (back) back->nxt = tail; else dst->tail = tail;
+    dst->length += count;
+    dst->indexed = 0;
+    dst->finger = 0x0;
+
+    first->origin = dst;
+    last->origin = dst;
+    return count;
+}
 
-    return 0x0;
+/*
+ * Description:
+ *    - Splits a list in two at the iterator's node, without copying any node.
+ *    - The node and everything behind it (towards the tail) move to a new list, where it becomes the head.
+ *    - The new list starts with an empty pool and the same unrolled capacity.
+ *
+ * Parameters:
+ *    - list_ptr => pointer to the list
+ *    - iterator_ptr => pointer to the first node of the new list
+ *
+ * Return: pointer to the new list_ptr
+ * Time Complexity: O(min(kept node, moved node)) (to count them)
+ */
+list_ptr *list_split(list_ptr *li, iterator_ptr *at) {
+    if (!li || !at || !at->points) return 0x0;
+    list_ptr *a = list_init();
+    if (!a) return 0x0;
+
+    list_t *back = at->points;
+    list_t *front = at->points->nxt;
+    int moved = 0, kept = 0;
+    while (back && front) { // count whichever side ends first
+        back = back->prev;
+        front = front->nxt;
+        moved++;
+        kept++;
+    }
+    int count = (!back) ? moved : li->length - kept;
+
+    a->head = at->points;
+    a->tail = li->tail;
+    a->length = count;
+    a->unrolled = li->unrolled;
+
+    li->tail = at->points->nxt;
+    if (li->tail) li->tail->prev = 0x0; else li->head = 0x0;
+    a->head->nxt = 0x0;
+    li->length -= count;
+    li->indexed = 0;
+    li->finger = 0x0;
+
+    at->origin = a;
+    return a;
+}
+
+/*
+ * Description:
+ *    - Appends every node of b behind the tail of a, leaving b empty. No node is copied.
+ *    - b keeps its pool and can still be used or freed afterward.
+ *
+ * Parameters:
+ *    - list_ptr => pointer to the list to append to
+ *    - list_ptr => pointer to the list to take the nodes from
+ *
+ * Time Complexity: O(1)
+ */
+void list_concat(list_ptr *a, list_ptr *b) {
+    if (!a || !b || a == b || !b->head) return;
+
+    b->head->nxt = a->tail;
+    if (a->tail) a->tail->prev = b->head; else a->head = b->head;
+    a->tail = b->tail;
+    a->length += b->length;
+    a->indexed = 0;
+    a->finger = 0x0;
+
+    b->head = 0x0;
+    b->tail = 0x0;
+    b->length = 0;
+    b->indexed = 0;
+    b->finger = 0x0;
 }
 
 #endif
@@ -0,0 +1,261 @@
+#ifndef stl_h
+#define stl_h
+
+// C++17 adapters over list.h and array.h: standard algorithms, execution policies included, run on the storage in place.
+
+#include <cstddef>
+#include <cstdlib>
+#include <iterator>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+
+#include "list.h"
+#include "array.h"
+
+namespace dsl {
+
+// [first, last) of a contiguous block: begin and end are plain pointers, so algorithms see a contiguous random-access range
+template <typename T>
+class span_range {
+public:
+    using value_type = std::remove_cv_t<T>;
+    using iterator = T *;
+
+    span_range() : first_(nullptr), last_(nullptr) {}
+    span_range(T *first, T *last) : first_(first), last_(last) {}
+
+    T *begin() const { return first_; }
+    T *end() const { return last_; }
+    T *data() const { return first_; }
+    std::size_t size() const { return last_ - first_; }
+    bool empty() const { return first_ == last_; }
+    T &operator[](std::size_t i) const { return first_[i]; }
+
+private:
+    T *first_;
+    T *last_;
+};
+
+// cells of an array as T, which must be exactly one cell wide (empty range otherwise); Bloom filters are rebuilt by the next search_s
+template <typename T>
+span_range<T> cells(array &a) {
+    if (a.size != sizeof(T) || !a.buffer) return span_range<T>();
+    if (a.filter) a.filter->stale = 1;
+    return span_range<T>(reinterpret_cast<T *>(a.buffer), reinterpret_cast<T *>(a.buffer) + a.length);
+}
+
+template <typename T>
+span_range<const T> cells(const array &a) {
+    if (a.size != sizeof(T) || !a.buffer) return span_range<const T>();
+    return span_range<const T>(reinterpret_cast<const T *>(a.buffer), reinterpret_cast<const T *>(a.buffer) + a.length);
+}
+
+// array of one node; the mutable overload drops its summary, hash index and borrowed spans first
+inline span_range<int> values(list_t &node) {
+    nodetouchcmp_1(&node);
+    return span_range<int>(node.array, node.array + node.size);
+}
+
+inline span_range<const int> values(const list_t &node) {
+    return span_range<const int>(node.array, node.array + node.size);
+}
+
+// nodes from head to tail
+template <bool Const>
+class basic_node_iterator {
+public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = list_t;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::conditional_t<Const, const list_t *, list_t *>;
+    using reference = std::conditional_t<Const, const list_t &, list_t &>;
+
+    basic_node_iterator() = default;
+    basic_node_iterator(const list_ptr *li, list_t *node) : li_(li), node_(node) {}
+    template <bool C, typename = std::enable_if_t<Const && !C>>
+    basic_node_iterator(const basic_node_iterator<C> &other) : li_(other.li_), node_(other.node_) {}
+
+    reference operator*() const { return *node_; }
+    pointer operator->() const { return node_; }
+
+    basic_node_iterator &operator++() {
+        node_ = node_->prev;
+        return *this;
+    }
+
+    basic_node_iterator operator++(int) {
+        basic_node_iterator tmp = *this;
+        ++*this;
+        return tmp;
+    }
+
+    basic_node_iterator &operator--() { // end() steps back onto the tail
+        node_ = (node_) ? node_->nxt : li_->tail;
+        return *this;
+    }
+
+    basic_node_iterator operator--(int) {
+        basic_node_iterator tmp = *this;
+        --*this;
+        return tmp;
+    }
+
+    bool operator==(const basic_node_iterator &other) const { return node_ == other.node_; }
+    bool operator!=(const basic_node_iterator &other) const { return node_ != other.node_; }
+
+private:
+    template <bool C> friend class basic_node_iterator;
+
+    const list_ptr *li_ = nullptr;
+    list_t *node_ = nullptr;
+};
+
+// every element of every node from head to tail, empty nodes skipped
+template <bool Const>
+class basic_element_iterator {
+public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = int;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::conditional_t<Const, const int *, int *>;
+    using reference = std::conditional_t<Const, const int &, int &>;
+
+    basic_element_iterator() = default;
+    basic_element_iterator(const list_ptr *li, list_t *node, int offset) : li_(li), node_(node), offset_(offset) {}
+    template <bool C, typename = std::enable_if_t<Const && !C>>
+    basic_element_iterator(const basic_element_iterator<C> &other) : li_(other.li_), node_(other.node_), offset_(other.offset_) {}
+
+    reference operator*() const { return node_->array[offset_]; }
+    pointer operator->() const { return node_->array + offset_; }
+
+    basic_element_iterator &operator++() {
+        if (++offset_ < node_->size) return *this;
+        node_ = towards_tail(node_->prev);
+        offset_ = 0;
+        return *this;
+    }
+
+    basic_element_iterator operator++(int) {
+        basic_element_iterator tmp = *this;
+        ++*this;
+        return tmp;
+    }
+
+    basic_element_iterator &operator--() { // end() steps back onto the last element of the tail
+        if (node_ && offset_ > 0) {
+            offset_--;
+            return *this;
+        }
+        node_ = towards_head((node_) ? node_->nxt : li_->tail);
+        offset_ = node_->size - 1;
+        return *this;
+    }
+
+    basic_element_iterator operator--(int) {
+        basic_element_iterator tmp = *this;
+        --*this;
+        return tmp;
+    }
+
+    bool operator==(const basic_element_iterator &other) const { return node_ == other.node_ && offset_ == other.offset_; }
+    bool operator!=(const basic_element_iterator &other) const { return !(*this == other); }
+
+    static list_t *towards_tail(list_t *node) {
+        while (node && node->size == 0) node = node->prev;
+        return node;
+    }
+
+    static list_t *towards_head(list_t *node) {
+        while (node && node->size == 0) node = node->nxt;
+        return node;
+    }
+
+private:
+    template <bool C> friend class basic_element_iterator;
+
+    const list_ptr *li_ = nullptr;
+    list_t *node_ = nullptr; // 0x0: end
+    int offset_ = 0;
+};
+
+using node_iterator = basic_node_iterator<false>;
+using const_node_iterator = basic_node_iterator<true>;
+using element_iterator = basic_element_iterator<false>;
+using const_element_iterator = basic_element_iterator<true>;
+
+template <typename Iterator>
+class list_range {
+public:
+    using iterator = Iterator;
+
+    list_range(Iterator first, Iterator last) : first_(first), last_(last) {}
+
+    Iterator begin() const { return first_; }
+    Iterator end() const { return last_; }
+    bool empty() const { return first_ == last_; }
+
+private:
+    Iterator first_;
+    Iterator last_;
+};
+
+// not for thread-safe lists, and the range must be dropped before the list is changed through its own calls
+inline list_range<node_iterator> nodes(list_ptr &li) {
+    return list_range<node_iterator>(node_iterator(&li, li.head), node_iterator(&li, nullptr));
+}
+
+inline list_range<const_node_iterator> nodes(const list_ptr &li) {
+    return list_range<const_node_iterator>(const_node_iterator(&li, li.head), const_node_iterator(&li, nullptr));
+}
+
+// the mutable overload drops every node's summary, hash index and borrowed spans first, as writes through it are not seen by the list
+inline list_range<element_iterator> elements(list_ptr &li) {
+    for (list_t *node = li.head; node; node = node->prev) nodetouchcmp_1(node);
+    return list_range<element_iterator>(element_iterator(&li, element_iterator::towards_tail(li.head), 0), element_iterator(&li, nullptr, 0));
+}
+
+inline list_range<const_element_iterator> elements(const list_ptr &li) {
+    return list_range<const_element_iterator>(const_element_iterator(&li, const_element_iterator::towards_tail(li.head), 0), const_element_iterator(&li, nullptr, 0));
+}
+
+// memory_resource over malloc: blocks it hands out can be adopted by an array or by list_adopt_bulk (free_data: TRUE), which release them with free
+class heap_resource : public std::pmr::memory_resource {
+protected:
+    void *do_allocate(std::size_t bytes, std::size_t alignment) override {
+        if (!bytes) bytes = 1;
+        void *block = (alignment <= alignof(std::max_align_t)) ? std::malloc(bytes) : std::aligned_alloc(alignment, (bytes + alignment - 1) / alignment * alignment);
+        if (!block) throw std::bad_alloc();
+        return block;
+    }
+
+    void do_deallocate(void *block, std::size_t, std::size_t) override {
+        std::free(block);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+        return dynamic_cast<const heap_resource *>(&other) != nullptr;
+    }
+};
+
+inline heap_resource *heap() {
+    static heap_resource resource;
+    return &resource;
+}
+
+template <typename T>
+using allocator = std::pmr::polymorphic_allocator<T>;
+
+// hands a block from heap() to an array as length cells of T, freeing its previous buffer
+template <typename T>
+void adopt(array &a, T *data, std::size_t length) {
+    std::free(a.buffer);
+    a.buffer = reinterpret_cast<unsigned char *>(data);
+    a.length = length;
+    a.size = sizeof(T);
+    if (a.filter) a.filter->stale = 1;
+}
+
+} // namespace dsl
+
+#endif
@@ -0,0 +1,544 @@
+#ifndef tlist_h
+#define tlist_h
+
+// C++17 list of nodes holding any trivially copyable element type, with 64-bit sizes; list<int, int> is list.h itself.
+
+#include <algorithm>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+#include "stl.h"
+
+namespace dsl {
+
+template <typename T, typename = void>
+struct has_equal : std::false_type {};
+
+template <typename T>
+struct has_equal<T, std::void_t<decltype(std::declval<const T &>() == std::declval<const T &>())>> : std::true_type {};
+
+// elements without operator== compare bytewise
+template <typename T>
+bool element_equal(const T &a, const T &b) {
+    if constexpr (has_equal<T>::value) return a == b;
+    else return std::memcmp(&a, &b, sizeof(T)) == 0;
+}
+
+template <std::size_t Bytes> struct radix_word;
+template <> struct radix_word<1> { using type = std::uint8_t; };
+template <> struct radix_word<2> { using type = std::uint16_t; };
+template <> struct radix_word<4> { using type = std::uint32_t; };
+template <> struct radix_word<8> { using type = std::uint64_t; };
+
+// integers up to 64 bits, and IEEE floats and doubles, sort by the bits of radix_key
+template <typename T>
+constexpr bool radix_sortable_v = sizeof(T) <= 8 && !std::is_same_v<T, bool> &&
+    (std::is_integral_v<T> || (std::is_floating_point_v<T> && std::numeric_limits<T>::is_iec559 && (sizeof(T) == 4 || sizeof(T) == 8)));
+
+// unsigned word ordered like value: the sign bit is flipped, negative floats have every bit flipped
+template <typename T>
+typename radix_word<sizeof(T)>::type radix_key(T value) {
+    using U = typename radix_word<sizeof(T)>::type;
+    constexpr U sign = U(U(1) << (sizeof(T) * 8 - 1));
+
+    U bits;
+    std::memcpy(&bits, &value, sizeof(T));
+    if constexpr (std::is_floating_point_v<T>) return (bits & sign) ? U(~bits) : U(bits | sign);
+    else if constexpr (std::is_signed_v<T>) return U(bits ^ sign);
+    else return bits;
+}
+
+// bytes for count elements of T, false when that overflows size_t
+template <typename T, typename SizeT>
+bool element_bytes(SizeT count, std::size_t &bytes) {
+    if (std::uintmax_t(count) > SIZE_MAX / sizeof(T)) return false;
+    bytes = std::size_t(count) * sizeof(T);
+    return true;
+}
+
+template <typename T, typename SizeT>
+void insertion_sort(T *arr, SizeT size) {
+    for (SizeT i = 1; i < size; i++) {
+        T key = arr[i];
+        SizeT j = i;
+        for (; j > 0 && key < arr[j - 1]; j--) arr[j] = arr[j - 1];
+        arr[j] = key;
+    }
+}
+
+template <typename T, typename SizeT>
+void bubble_sort(T *arr, SizeT size) {
+    for (SizeT i = 0; i + 1 < size; i++) {
+        bool swap = false;
+        for (SizeT j = 0; j + 1 < size - i; j++) {
+            if (arr[j + 1] < arr[j]) {
+                std::swap(arr[j], arr[j + 1]);
+                swap = true;
+            }
+        }
+        if (!swap) break;
+    }
+}
+
+// LSD, 8 bits per pass over radix_key, passes whose digit every key shares are skipped
+template <typename T, typename SizeT>
+void radix_sort(T *arr, SizeT size) {
+    if (size <= 64) {
+        insertion_sort(arr, size);
+        return;
+    }
+
+    std::size_t bytes;
+    T *scratch = element_bytes<T>(size, bytes) ? static_cast<T *>(std::malloc(bytes)) : nullptr;
+    if (!scratch) {
+        std::sort(arr, arr + size);
+        return;
+    }
+
+    constexpr int passes = sizeof(T);
+    SizeT count[passes][256] = {};
+    for (SizeT i = 0; i < size; i++) {
+        auto key = radix_key(arr[i]);
+        for (int pass = 0; pass < passes; pass++) count[pass][(key >> (pass * 8)) & 0xFF]++;
+    }
+
+    T *src = arr;
+    T *dst = scratch;
+    for (int pass = 0; pass < passes; pass++) {
+        int shift = pass * 8;
+        if (count[pass][(radix_key(src[0]) >> shift) & 0xFF] == size) continue;
+
+        SizeT offset = 0;
+        for (int d = 0; d < 256; d++) {
+            SizeT c = count[pass][d];
+            count[pass][d] = offset;
+            offset += c;
+        }
+
+        for (SizeT i = 0; i < size; i++) dst[count[pass][(radix_key(src[i]) >> shift) & 0xFF]++] = src[i];
+        std::swap(src, dst);
+    }
+
+    if (src != arr) std::memcpy(arr, src, bytes);
+    std::free(scratch);
+}
+
+// option => 0: bubble | 1: merge (stable) | 2: radix, introsort for types radix_key cannot order | 3: introsort
+template <typename T, typename SizeT>
+void sort_kernel(T *arr, SizeT size, int option) {
+    switch (option) {
+        case 0:
+            bubble_sort(arr, size);
+            break;
+        case 1:
+            std::stable_sort(arr, arr + size);
+            break;
+        case 2:
+            if constexpr (radix_sortable_v<T>) radix_sort(arr, size);
+            else std::sort(arr, arr + size);
+            break;
+        case 3:
+            std::sort(arr, arr + size);
+            break;
+    }
+}
+
+// first position from start towards end (backward when start > end) holding any target, npos otherwise
+template <typename T, typename SizeT>
+SizeT linear_search(const T *arr, SizeT start, SizeT end, const T *target, SizeT target_size) {
+    constexpr SizeT npos = SizeT(-1);
+
+    if constexpr (std::is_same_v<T, int>) { // list.h's simd kernels, picked at runtime
+        if (start <= INT_MAX && end <= INT_MAX && target_size <= INT_MAX) {
+            int result;
+#ifdef LIST_SIMD_X86
+            switch (simdlevelcmp_1()) {
+                case 2:
+                    result = linearsearchcmp_4(arr, (int) start, (int) end, target, (int) target_size);
+                    break;
+                case 1:
+                    result = linearsearchcmp_3(arr, (int) start, (int) end, target, (int) target_size);
+                    break;
+                default:
+                    result = linearsearchcmp_2(arr, (int) start, (int) end, target, (int) target_size);
+            }
+#else
+            result = linearsearchcmp_2(arr, (int) start, (int) end, target, (int) target_size);
+#endif
+            return (result == -1) ? npos : SizeT(result);
+        }
+    }
+
+    if constexpr (std::is_arithmetic_v<T>) { // blocks of 16 are compared without branching, so the compiler vectorizes them
+        if (start <= end && target_size == 1) {
+            const T needle = target[0];
+            SizeT i = start;
+            for (; i <= end && end - i >= 15; i += 16) {
+                bool hit = false;
+                for (int k = 0; k < 16; k++) hit |= arr[i + k] == needle;
+                if (hit) break;
+            }
+            for (; i <= end; i++) if (arr[i] == needle) return i;
+            return npos;
+        }
+    }
+
+    for (SizeT i = start;; i = (start <= end) ? i + 1 : i - 1) {
+        for (SizeT j = 0; j < target_size; j++) if (element_equal(arr[i], target[j])) return i;
+        if (i == end) return npos;
+    }
+}
+
+// lowest position in [start, end] matching any target, arr sorted
+template <typename T, typename SizeT>
+SizeT binary_search(const T *arr, SizeT start, SizeT end, const T *target, SizeT target_size) {
+    SizeT result = SizeT(-1);
+    for (SizeT j = 0; j < target_size; j++) {
+        const T *position = std::lower_bound(arr + start, arr + end + 1, target[j]);
+        if (position <= arr + end && element_equal(*position, target[j]) && SizeT(position - arr) < result) result = position - arr;
+    }
+    return result;
+}
+
+/*
+ * Nodes from head to tail, each one array of T. This is a separate, minimal implementation, not
+ * list.h with wider types: it has push, pop, write, erase, reserve, shrink, sort, find and values
+ * only. There is no insert or remove by global position, no unrolled directory, no iterators,
+ * no splice, no summaries, hashes or eytzinger layouts and no thread-safe mode; list<int, int>
+ * below is list.h itself and keeps all of them. Index counts nodes from the head (-1: the tail),
+ * start and end are element positions, npos stands for -1. T is moved with memcpy and reserved
+ * elements read as all 0xFF bytes, like the int arrays. Sizes whose bytes overflow size_t are refused.
+ */
+template <typename T, typename SizeT = std::uint64_t>
+class list {
+    static_assert(std::is_trivially_copyable_v<T>, "elements are moved with memcpy");
+    static_assert(std::is_unsigned_v<SizeT>, "sizes are unsigned, list<int, int> keeps list.h's int API");
+    static_assert(alignof(T) <= alignof(std::max_align_t), "arrays come from malloc");
+
+public:
+    using value_type = T;
+    using size_type = SizeT;
+    using index_type = std::make_signed_t<SizeT>;
+    static constexpr SizeT npos = SizeT(-1);
+
+    struct node {
+        T *array;
+        SizeT size;
+        SizeT capacity;
+        node *nxt; // towards the head
+        node *prev; // towards the tail
+        int flags; // LIST_SORTED
+    };
+
+    list() = default;
+    list(const list &) = delete;
+    list &operator=(const list &) = delete;
+
+    list(list &&other) noexcept { swap(other); }
+
+    list &operator=(list &&other) noexcept {
+        if (this != &other) {
+            clear();
+            swap(other);
+        }
+        return *this;
+    }
+
+    ~list() { clear(); }
+
+    void swap(list &other) noexcept {
+        std::swap(head_, other.head_);
+        std::swap(tail_, other.tail_);
+        std::swap(length_, other.length_);
+    }
+
+    // location => FRONT | BACK
+    void push(int location, SizeT size, const T *input) {
+        std::size_t bytes;
+        if (!size || !input || (location != FRONT && location != BACK) || !element_bytes<T>(size, bytes)) return;
+
+        node *a = static_cast<node *>(std::malloc(sizeof(node)));
+        if (!a) return;
+        a->array = static_cast<T *>(std::malloc(bytes));
+        if (!a->array) {
+            std::free(a);
+            return;
+        }
+
+        std::memcpy(a->array, input, bytes);
+        a->size = size;
+        a->capacity = size;
+        a->flags = 0;
+
+        if (location == FRONT) {
+            a->nxt = nullptr;
+            a->prev = head_;
+            if (head_) head_->nxt = a; else tail_ = a;
+            head_ = a;
+        } else {
+            a->nxt = tail_;
+            a->prev = nullptr;
+            if (tail_) tail_->prev = a; else head_ = a;
+            tail_ = a;
+        }
+        length_++;
+    }
+
+    void pop(int location) {
+        if (!head_ || (location != FRONT && location != BACK)) return;
+
+        node *a = (location == FRONT) ? head_ : tail_;
+        if (location == FRONT) {
+            head_ = a->prev;
+            if (head_) head_->nxt = nullptr; else tail_ = nullptr;
+        } else {
+            tail_ = a->nxt;
+            if (tail_) tail_->prev = nullptr; else head_ = nullptr;
+        }
+
+        std::free(a->array);
+        std::free(a);
+        length_--;
+    }
+
+    void clear() {
+        while (head_) pop(FRONT);
+    }
+
+    // nodes in the list
+    SizeT length() const { return length_; }
+
+    node *head() const { return head_; }
+    node *tail() const { return tail_; }
+
+    // walks from the closer end (nullptr: no such node)
+    node *locate(index_type index) const {
+        if (index < 0) index += index_type(length_);
+        if (index < 0 || SizeT(index) >= length_) return nullptr;
+
+        node *current;
+        if (SizeT(index) < length_ - 1 - SizeT(index)) {
+            current = head_;
+            for (; index > 0; index--) current = current->prev;
+        } else {
+            current = tail_;
+            for (SizeT count = length_ - 1; count > SizeT(index); count--) current = current->nxt;
+        }
+        return current;
+    }
+
+    // npos: no such node
+    SizeT size(index_type index) const {
+        node *current = locate(index);
+        return (current) ? current->size : npos;
+    }
+
+    // writes end - start + 1 elements, growing the array past end with reserved extra elements; start = end = npos: the last element
+    void write(index_type index, SizeT start, SizeT end, const T *input, SizeT reserved) {
+        node *current = locate(index);
+        if (!current || !input) return;
+
+        if (start == npos && end == npos) {
+            if (!current->size) return;
+            start = end = current->size - 1;
+        }
+        if (start > end || end == npos) return;
+
+        if (end >= current->size) {
+            if (reserved > npos - 1 - end) return;
+            SizeT size = end + 1 + reserved;
+            if (!grow(current, size)) return;
+
+            std::memset(static_cast<void *>(current->array + current->size), 0xFF, (size - current->size) * sizeof(T));
+            current->size = size;
+        }
+
+        std::memcpy(current->array + start, input, (end - start + 1) * sizeof(T));
+        current->flags &= ~LIST_SORTED;
+    }
+
+    // free_memory => false: size stays, the vacated end reads all 0xFF bytes | true: shrinks once at most a quarter full
+    void erase(index_type index, SizeT start, SizeT end, bool free_memory) {
+        node *current = locate(index);
+        if (!current) return;
+
+        if (start == npos && end == npos) start = end = current->size - 1;
+        if (start > end || end >= current->size) return;
+
+        SizeT erased = end - start + 1;
+        SizeT size = current->size - erased;
+        std::memmove(current->array + start, current->array + end + 1, (current->size - (end + 1)) * sizeof(T));
+
+        if (!free_memory) {
+            std::memset(static_cast<void *>(current->array + size), 0xFF, erased * sizeof(T));
+            current->flags &= ~LIST_SORTED;
+            return;
+        }
+
+        current->size = size;
+        if (size && size <= current->capacity / 4) fit(current, size); // erasing keeps the order
+    }
+
+    void reserve(index_type index, SizeT capacity) {
+        node *current = locate(index);
+        if (current) grow(current, capacity);
+    }
+
+    void shrink(index_type index) {
+        node *current = locate(index);
+        if (current && current->size) fit(current, current->size);
+    }
+
+    // option => 0: bubble | 1: merge | 2: radix (integers and floats, introsort otherwise) | 3: introsort
+    void sort(index_type index, int option) {
+        node *current = locate(index);
+        if (!current || option < 0 || option > 3) return;
+
+        sort_kernel(current->array, current->size, option);
+        current->flags |= LIST_SORTED;
+    }
+
+    /*
+     * option => 0: linear search (backward when start > end) | 1: binary search (sorted array)
+     * A forward linear search on an array sorted by sort() runs as a binary search.
+     * Returns the first position holding any target, npos otherwise.
+     */
+    SizeT find(index_type index, SizeT start, SizeT end, const T *target, SizeT target_size, int option) const {
+        node *current = locate(index);
+        if (!current || !target || !target_size || start >= current->size || end >= current->size) return npos;
+        if (option == 0 && start <= end && (current->flags & LIST_SORTED)) option = 1;
+
+        switch (option) {
+            case 0:
+                return linear_search(current->array, start, end, target, target_size);
+            case 1:
+                return (start <= end) ? binary_search(current->array, start, end, target, target_size) : npos;
+            default:
+                return npos;
+        }
+    }
+
+    // array of one node; the mutable overload forgets it was sorted
+    span_range<T> values(index_type index) {
+        node *current = locate(index);
+        if (!current) return span_range<T>();
+        current->flags &= ~LIST_SORTED;
+        return span_range<T>(current->array, current->array + current->size);
+    }
+
+    span_range<const T> values(index_type index) const {
+        node *current = locate(index);
+        if (!current) return span_range<const T>();
+        return span_range<const T>(current->array, current->array + current->size);
+    }
+
+private:
+    // capacity at least doubles, so writing one element past the end at a time is amortized O(1)
+    static bool grow(node *current, SizeT capacity) {
+        if (capacity <= current->capacity) return true;
+        if (current->capacity <= npos / 2 && capacity < current->capacity * 2) capacity = current->capacity * 2;
+
+        std::size_t bytes;
+        if (!element_bytes<T>(capacity, bytes)) return false;
+        T *array = static_cast<T *>(std::realloc(current->array, bytes));
+        if (!array) return false;
+
+        current->array = array;
+        current->capacity = capacity;
+        return true;
+    }
+
+    // capacity never exceeds the current one, whose bytes grow or push already checked
+    static void fit(node *current, SizeT capacity) {
+        T *array = static_cast<T *>(std::realloc(current->array, capacity * sizeof(T)));
+        if (!array) return;
+
+        current->array = array;
+        current->capacity = capacity;
+    }
+
+    node *head_ = nullptr;
+    node *tail_ = nullptr;
+    SizeT length_ = 0;
+};
+
+// list.h itself: the same calls on a list_ptr, with its pools, hash and eytzinger indexes, summaries and thread-safe mode
+template <>
+class list<int, int> {
+public:
+    using value_type = int;
+    using size_type = int;
+    using index_type = int;
+    static constexpr int npos = -1;
+    using node = list_t;
+
+    list() : li_(list_init()) {}
+    list(const list &) = delete;
+    list &operator=(const list &) = delete;
+
+    list(list &&other) noexcept : li_(other.li_) { other.li_ = nullptr; }
+
+    list &operator=(list &&other) noexcept {
+        if (this != &other) {
+            release();
+            li_ = other.li_;
+            other.li_ = nullptr;
+        }
+        return *this;
+    }
+
+    ~list() { release(); }
+
+    // the rest of list.h takes this
+    list_ptr *get() const { return li_; }
+
+    void push(int location, int size, const int *input) { list_push(li_, location, size, const_cast<int *>(input)); }
+    void pop(int location) { list_pop(li_, location); }
+    void clear() { list_clear(li_); }
+
+    int length() const { return (li_) ? li_->length : 0; }
+    node *head() const { return (li_) ? li_->head : nullptr; }
+    node *tail() const { return (li_) ? li_->tail : nullptr; }
+    node *locate(int index) const { return (li_) ? nodelocatecmp_1(li_, index) : nullptr; }
+    int size(int index) const { return list_size(li_, index); }
+
+    void write(int index, int start, int end, const int *input, int reserved) { list_write(li_, index, start, end, const_cast<int *>(input), reserved); }
+    void erase(int index, int start, int end, bool free_memory) { list_erase(li_, index, start, end, (free_memory) ? TRUE : FALSE); }
+    void reserve(int index, int capacity) { list_reserve(li_, index, capacity); }
+    void shrink(int index) { list_shrink(li_, index); }
+    void sort(int index, int option) { list_sort(li_, index, option); }
+
+    // option => 0: linear | 1: binary | 2: hash lookup (LIST_HASHED)
+    int find(int index, int start, int end, const int *target, int target_size, int option) const {
+        return list_find(li_, index, start, end, const_cast<int *>(target), target_size, option, 0);
+    }
+
+    span_range<int> values(int index) {
+        node *current = locate(index);
+        return (current) ? dsl::values(*current) : span_range<int>();
+    }
+
+    span_range<const int> values(int index) const {
+        const node *current = locate(index);
+        return (current) ? dsl::values(*current) : span_range<const int>();
+    }
+
+private:
+    void release() {
+        if (!li_) return;
+        list_free(li_); // leaves the list_ptr itself
+        std::free(li_);
+        li_ = nullptr;
+    }
+
+    list_ptr *li_;
+};
+
+} // namespace dsl
+
+#endif